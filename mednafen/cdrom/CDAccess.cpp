@@ -19,6 +19,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <string.h>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -27,6 +28,7 @@
 
 #include "CDAccess.h"
 #include "CDAccess_Image.h"
+#include "CDAccess_CHD.h"
 
 #ifdef HAVE_LIBCDIO
 #include "CDAccess_Physical.h"
@@ -44,6 +46,11 @@ CDAccess::~CDAccess()
 
 }
 
+void CDAccess::HintReadSectors(int32, int32)
+{
+
+}
+
 CDAccess *cdaccess_open(const char *path)
 {
  CDAccess *ret;
@@ -54,6 +61,9 @@ CDAccess *cdaccess_open(const char *path)
   ret = new CDAccess_Physical(path);
  else
  #endif
+ if(strlen(path) >= 4 && !strcasecmp(path + strlen(path) - 4, ".chd"))
+  ret = new CDAccess_CHD(path);
+ else
   ret = new CDAccess_Image(path);
 
  return ret;
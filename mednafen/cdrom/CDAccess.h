@@ -14,6 +14,9 @@ class CDAccess
 
  virtual void Read_Raw_Sector(uint8 *buf, int32 lba) = 0;
 
+ // Tells the backend that sectors lba through lba + count - 1 will probably be read soon.  Default is a NOP.
+ virtual void HintReadSectors(int32 lba, int32 count);
+
  virtual void Read_TOC(CDUtility::TOC *toc) = 0;
 
  virtual bool Is_Physical(void) = 0;
@@ -0,0 +1,831 @@
+/* Mednafen - Multi-system Emulator
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ Notes and TODO:
+
+	Only CHD version 5 is supported, and only the "zlib" and "cdzl" codecs; chdman picks between LZMA, zlib and FLAC per hunk
+	by default, so images have to be made with "chdman createcd -c cdzl".
+
+	Parent(delta) CHDs are not supported.
+*/
+
+#include "../mednafen.h"
+
+#include <string.h>
+#include <errno.h>
+#include "../include/trio/trio.h"
+#include "../zlib.h"
+
+#include "../general.h"
+#include "../mednafen-endian.h"
+
+#include "CDAccess.h"
+#include "CDAccess_CHD.h"
+
+using namespace CDUtility;
+
+enum { CHD_V5_HEADER_SIZE = 124 };
+enum { CD_FRAME_SIZE = 2352 + 96 };
+
+// Roughly CDIF's maximum read-ahead, in sectors.
+enum { CHD_READ_AHEAD_SECTORS = 16 };
+
+#define CHD_MAKE_TAG(a, b, c, d) (((uint32)(a) << 24) | ((uint32)(b) << 16) | ((uint32)(c) << 8) | (uint32)(d))
+
+static const uint32 CHD_CODEC_ZLIB = CHD_MAKE_TAG('z', 'l', 'i', 'b');
+static const uint32 CHD_CODEC_CD_ZLIB = CHD_MAKE_TAG('c', 'd', 'z', 'l');
+
+static const uint32 CHD_TRACK_METADATA_TAG = CHD_MAKE_TAG('C', 'H', 'T', 'R');
+static const uint32 CHD_TRACK_METADATA2_TAG = CHD_MAKE_TAG('C', 'H', 'T', '2');
+
+// Hunk map entry types.
+enum
+{
+ CHD_COMP_TYPE_0 = 0,	// Compressed with compressors[0] through [3].
+ CHD_COMP_TYPE_1,
+ CHD_COMP_TYPE_2,
+ CHD_COMP_TYPE_3,
+ CHD_COMP_NONE,		// Stored uncompressed.
+ CHD_COMP_SELF,		// Same data as another hunk in this file.
+ CHD_COMP_PARENT,	// Same data as a hunk in the parent CHD.
+
+ // Only appear in the compressed map itself.
+ CHD_COMP_RLE_SMALL,
+ CHD_COMP_RLE_LARGE,
+ CHD_COMP_SELF_0,
+ CHD_COMP_SELF_1,
+ CHD_COMP_PARENT_SELF,
+ CHD_COMP_PARENT_0,
+ CHD_COMP_PARENT_1,
+
+ // Ours, for maps of uncompressed CHDs, which have no CRCs.
+ CHD_COMP_NONE_NOCRC = 0x80,
+ CHD_COMP_ZERO
+};
+
+static const char *CHD_Type_Strings[_DI_FORMAT_COUNT] =
+{
+ "AUDIO",
+ "MODE1",
+ "MODE1_RAW",
+ "MODE2",
+ "MODE2_FORM1",
+ "MODE2_FORM2",
+ "MODE2_RAW"
+};
+
+static const uint8 CD_Sync_Header[12] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+static uint16 CRC16(const uint8 *data, uint32 len)
+{
+ static uint16 table[256];
+ static bool table_ok = false;
+ uint16 crc = 0xFFFF;
+
+ if(!table_ok)
+ {
+  for(unsigned i = 0; i < 256; i++)
+  {
+   uint16 v = i << 8;
+
+   for(unsigned b = 0; b < 8; b++)
+    v = (v << 1) ^ ((v & 0x8000) ? 0x1021 : 0);
+
+   table[i] = v;
+  }
+  table_ok = true;
+ }
+
+ while(len--)
+  crc = (crc << 8) ^ table[(crc >> 8) ^ *data++];
+
+ return(crc);
+}
+
+// MSB-first bit reader for the compressed hunk map.  Reads past the end return 0 bits.
+class CHD_BitReader
+{
+ public:
+
+ CHD_BitReader(const uint8 *data_, uint32 len_) : data(data_), len(len_), offset(0), buffer(0), bits(0)
+ {
+
+ }
+
+ uint32 Peek(int count)
+ {
+  if(!count)
+   return(0);
+
+  if(count > bits)
+  {
+   while(bits <= 24)
+   {
+    if(offset < len)
+     buffer |= data[offset] << (24 - bits);
+    offset++;
+    bits += 8;
+   }
+  }
+
+  return(buffer >> (32 - count));
+ }
+
+ void Remove(int count)
+ {
+  buffer <<= count;
+  bits -= count;
+ }
+
+ uint32 Read(int count)
+ {
+  uint32 ret;
+
+  if(count > 24)
+  {
+   ret = Read(count - 16) << 16;
+   return(ret | Read(16));
+  }
+
+  ret = Peek(count);
+  Remove(count);
+
+  return(ret);
+ }
+
+ bool Overflow(void)
+ {
+  return((offset - bits / 8) > len);
+ }
+
+ private:
+
+ const uint8 *data;
+ uint32 len;
+ uint32 offset;
+ uint32 buffer;
+ int bits;
+};
+
+// Canonical Huffman decoder for the 16 hunk map entry types, codes of up to 8 bits.
+class CHD_MapHuffman
+{
+ public:
+
+ enum { NumCodes = 16, MaxBits = 8 };
+
+ // Reads the RLE-encoded code lengths and builds the lookup table.  Returns false on bad data.
+ bool ImportTree(CHD_BitReader *br)
+ {
+  uint8 numbits[NumCodes];
+  uint32 bithisto[33];
+  unsigned curnode = 0;
+
+  while(curnode < NumCodes)
+  {
+   int nodebits = br->Read(4);
+
+   if(nodebits != 1)
+    numbits[curnode++] = nodebits;
+   else
+   {
+    nodebits = br->Read(4);
+
+    if(nodebits == 1)
+     numbits[curnode++] = nodebits;
+    else
+    {
+     unsigned repcount = br->Read(4) + 3;
+
+     if(repcount + curnode > NumCodes)
+      return(false);
+
+     while(repcount--)
+      numbits[curnode++] = nodebits;
+    }
+   }
+  }
+
+  memset(bithisto, 0, sizeof(bithisto));
+
+  for(unsigned i = 0; i < NumCodes; i++)
+  {
+   if(numbits[i] > MaxBits)
+    return(false);
+   bithisto[numbits[i]]++;
+  }
+
+  uint32 curstart = 0;
+
+  for(int codelen = 32; codelen > 0; codelen--)
+  {
+   uint32 nextstart = (curstart + bithisto[codelen]) >> 1;
+
+   if(codelen != 1 && nextstart * 2 != (curstart + bithisto[codelen]))
+    return(false);
+
+   bithisto[codelen] = curstart;
+   curstart = nextstart;
+  }
+
+  memset(lookup, 0, sizeof(lookup));
+
+  for(unsigned i = 0; i < NumCodes; i++)
+  {
+   if(numbits[i] > 0)
+   {
+    const uint32 code = bithisto[numbits[i]]++;
+    const int shift = MaxBits - numbits[i];
+
+    for(uint32 j = code << shift; j < ((code + 1) << shift); j++)
+     lookup[j] = (i << 5) | numbits[i];
+   }
+  }
+
+  return(!br->Overflow());
+ }
+
+ uint8 Decode(CHD_BitReader *br)
+ {
+  const uint16 l = lookup[br->Peek(MaxBits)];
+
+  br->Remove(l & 0x1F);
+
+  return(l >> 5);
+ }
+
+ private:
+
+ uint16 lookup[1 << MaxBits];
+};
+
+CDAccess_CHD::CDAccess_CHD(const char *path) : fp(NULL), hunk_cache_clock(0)
+{
+ uint8 header[CHD_V5_HEADER_SIZE];
+ uint64 logicalbytes, map_offset, meta_offset;
+ uint32 unitbytes;
+
+ if(!(fp = fopen(path, "rb")))
+ {
+  ErrnoHolder ene(errno);
+
+  throw MDFN_Error(ene.Errno(), _("Could not open CHD file \"%s\": %s"), path, ene.StrError());
+ }
+
+ try
+ {
+  if(fread(header, 1, sizeof(header), fp) != sizeof(header) || memcmp(header, "MComprHD", 8))
+   throw MDFN_Error(0, _("\"%s\" is not a CHD file."), path);
+
+  if(MDFN_de32msb(&header[12]) != 5)
+   throw MDFN_Error(0, _("CHD version %u is not supported, only version 5 is."), MDFN_de32msb(&header[12]));
+
+  for(int i = 0; i < 4; i++)
+  {
+   compressors[i] = MDFN_de32msb(&header[16 + i * 4]);
+
+   if(compressors[i] && compressors[i] != CHD_CODEC_ZLIB && compressors[i] != CHD_CODEC_CD_ZLIB)
+   {
+    throw MDFN_Error(0, _("CHD uses the unsupported \"%c%c%c%c\" codec; only zlib-compressed images(chdman createcd -c cdzl) can be read."),
+	(char)(compressors[i] >> 24), (char)(compressors[i] >> 16), (char)(compressors[i] >> 8), (char)compressors[i]);
+   }
+  }
+
+  logicalbytes = ((uint64)MDFN_de32msb(&header[32]) << 32) | MDFN_de32msb(&header[36]);
+  map_offset = ((uint64)MDFN_de32msb(&header[40]) << 32) | MDFN_de32msb(&header[44]);
+  meta_offset = ((uint64)MDFN_de32msb(&header[48]) << 32) | MDFN_de32msb(&header[52]);
+  hunkbytes = MDFN_de32msb(&header[56]);
+  unitbytes = MDFN_de32msb(&header[60]);
+
+  for(int i = 0; i < 20; i++)
+  {
+   if(header[104 + i])
+    throw MDFN_Error(0, _("Parent(delta) CHD files are not supported."));
+  }
+
+  if(unitbytes != CD_FRAME_SIZE || !hunkbytes || (hunkbytes % CD_FRAME_SIZE))
+   throw MDFN_Error(0, _("CHD file is not a CD image."));
+
+  hunkcount = (logicalbytes + hunkbytes - 1) / hunkbytes;
+  frames_per_hunk = hunkbytes / CD_FRAME_SIZE;
+
+  LoadMap(map_offset, unitbytes);
+  LoadTOC(meta_offset);
+
+  if((uint64)Tracks[LastTrack].FileOffset + Tracks[LastTrack].pregap_dv + Tracks[LastTrack].sectors > (uint64)hunkcount * frames_per_hunk)
+   throw MDFN_Error(0, _("CHD track layout is larger than the image data."));
+
+  const unsigned cache_count = 2 + (CHD_READ_AHEAD_SECTORS + frames_per_hunk - 1) / frames_per_hunk;
+
+  hunk_cache.resize(cache_count * hunkbytes);
+  hunk_cache_num.resize(cache_count, ~0U);
+  hunk_cache_used.resize(cache_count, 0);
+ }
+ catch(...)
+ {
+  fclose(fp);
+  fp = NULL;
+  throw;
+ }
+}
+
+CDAccess_CHD::~CDAccess_CHD()
+{
+ if(fp)
+ {
+  fclose(fp);
+  fp = NULL;
+ }
+}
+
+void CDAccess_CHD::ReadFile(uint64 offset, uint8 *dest, uint32 len)
+{
+ if(fseek(fp, offset, SEEK_SET) || fread(dest, 1, len, fp) != len)
+  throw MDFN_Error(0, _("Error reading CHD file at offset %llu."), (unsigned long long)offset);
+}
+
+void CDAccess_CHD::LoadMap(uint64 map_offset, uint32 unitbytes)
+{
+ hunk_map.resize(hunkcount);
+
+ // Uncompressed CHD: just an offset(in hunks) per hunk, 0 meaning all zeroes.
+ if(!compressors[0])
+ {
+  std::vector<uint8> raw(hunkcount * 4);
+
+  ReadFile(map_offset, &raw[0], hunkcount * 4);
+
+  for(uint32 i = 0; i < hunkcount; i++)
+  {
+   const uint64 offset = (uint64)MDFN_de32msb(&raw[i * 4]) * hunkbytes;
+
+   hunk_map[i].comp = offset ? CHD_COMP_NONE_NOCRC : CHD_COMP_ZERO;
+   hunk_map[i].length = hunkbytes;
+   hunk_map[i].offset = offset;
+   hunk_map[i].crc = 0;
+  }
+  return;
+ }
+
+ uint8 map_header[16];
+ ReadFile(map_offset, map_header, sizeof(map_header));
+
+ const uint32 mapbytes = MDFN_de32msb(&map_header[0]);
+ const uint64 firstoffs = ((uint64)MDFN_de16msb(&map_header[4]) << 32) | MDFN_de32msb(&map_header[6]);
+ const uint16 mapcrc = MDFN_de16msb(&map_header[10]);
+ const int lengthbits = map_header[12];
+ const int selfbits = map_header[13];
+ const int parentbits = map_header[14];
+ std::vector<uint8> compressed(mapbytes + 1);
+
+ ReadFile(map_offset + 16, &compressed[0], mapbytes);
+
+ CHD_BitReader br(&compressed[0], mapbytes);
+ CHD_MapHuffman huff;
+
+ if(!huff.ImportTree(&br))
+  throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+ // First the entry types, run-length encoded...
+ {
+  uint8 lastcomp = 0;
+  int repcount = 0;
+
+  for(uint32 i = 0; i < hunkcount; i++)
+  {
+   if(repcount > 0)
+   {
+    hunk_map[i].comp = lastcomp;
+    repcount--;
+   }
+   else
+   {
+    const uint8 val = huff.Decode(&br);
+
+    if(val == CHD_COMP_RLE_SMALL)
+    {
+     hunk_map[i].comp = lastcomp;
+     repcount = 2 + huff.Decode(&br);
+    }
+    else if(val == CHD_COMP_RLE_LARGE)
+    {
+     hunk_map[i].comp = lastcomp;
+     repcount = 2 + 16 + (huff.Decode(&br) << 4);
+     repcount += huff.Decode(&br);
+    }
+    else
+     hunk_map[i].comp = lastcomp = val;
+   }
+  }
+ }
+
+ // ...then the lengths, offsets and CRCs that go with them.
+ {
+  std::vector<uint8> rawmap(hunkcount * 12);
+  uint64 curoffset = firstoffs;
+  uint64 last_self = 0;
+  uint64 last_parent = 0;
+
+  for(uint32 i = 0; i < hunkcount; i++)
+  {
+   HunkMapEntry *e = &hunk_map[i];
+   uint64 offset = curoffset;
+   uint32 length = 0;
+   uint16 crc = 0;
+
+   switch(e->comp)
+   {
+    case CHD_COMP_TYPE_0:
+    case CHD_COMP_TYPE_1:
+    case CHD_COMP_TYPE_2:
+    case CHD_COMP_TYPE_3:
+	curoffset += length = br.Read(lengthbits);
+	crc = br.Read(16);
+	break;
+
+    case CHD_COMP_NONE:
+	curoffset += length = hunkbytes;
+	crc = br.Read(16);
+	break;
+
+    case CHD_COMP_SELF:
+	last_self = offset = br.Read(selfbits);
+	break;
+
+    case CHD_COMP_PARENT:
+	last_parent = offset = br.Read(parentbits);
+	break;
+
+    case CHD_COMP_SELF_1:
+	last_self++;
+	// Fall through
+    case CHD_COMP_SELF_0:
+	e->comp = CHD_COMP_SELF;
+	offset = last_self;
+	break;
+
+    case CHD_COMP_PARENT_SELF:
+	e->comp = CHD_COMP_PARENT;
+	last_parent = offset = ((uint64)i * hunkbytes) / unitbytes;
+	break;
+
+    case CHD_COMP_PARENT_1:
+	last_parent += hunkbytes / unitbytes;
+	// Fall through
+    case CHD_COMP_PARENT_0:
+	e->comp = CHD_COMP_PARENT;
+	offset = last_parent;
+	break;
+
+    default:
+	throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+   }
+
+   // chdman only ever refers back to earlier hunks; anything else could make DecompressHunk() recurse in a cycle.
+   if(e->comp == CHD_COMP_SELF && offset >= i)
+    throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+   e->length = length;
+   e->offset = offset;
+   e->crc = crc;
+
+   // The map CRC is over the decoded form of the map.
+   uint8 *r = &rawmap[i * 12];
+   r[0] = e->comp;
+   r[1] = length >> 16;
+   r[2] = length >> 8;
+   r[3] = length;
+   for(int b = 0; b < 6; b++)
+    r[4 + b] = offset >> (40 - b * 8);
+   r[10] = crc >> 8;
+   r[11] = crc;
+  }
+
+  if(br.Overflow() || CRC16(&rawmap[0], hunkcount * 12) != mapcrc)
+   throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+ }
+}
+
+void CDAccess_CHD::LoadTOC(uint64 meta_offset)
+{
+ struct
+ {
+  bool present;
+  unsigned frames, pregap, postgap;
+  bool pregap_stored;
+ } tinfo[100];
+
+ memset(tinfo, 0, sizeof(tinfo));
+
+ FirstTrack = 99;
+ LastTrack = 0;
+
+ while(meta_offset)
+ {
+  uint8 mh[16];
+  ReadFile(meta_offset, mh, sizeof(mh));
+
+  const uint32 tag = MDFN_de32msb(&mh[0]);
+  const uint32 length = MDFN_de24msb(&mh[5]);
+  const uint64 next = ((uint64)MDFN_de32msb(&mh[8]) << 32) | MDFN_de32msb(&mh[12]);
+
+  if((tag == CHD_TRACK_METADATA_TAG || tag == CHD_TRACK_METADATA2_TAG) && length < 256)
+  {
+   char meta[256];
+   char type[32], subtype[32], pgtype[32], pgsub[32];
+   int tnum = 0, frames = 0, pregap = 0, postgap = 0;
+   int format;
+
+   ReadFile(meta_offset + 16, (uint8 *)meta, length);
+   meta[length] = 0;
+
+   pgtype[0] = 0;
+
+   if(tag == CHD_TRACK_METADATA2_TAG)
+   {
+    if(trio_sscanf(meta, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d PREGAP:%d PGTYPE:%31s PGSUB:%31s POSTGAP:%d",
+	&tnum, type, subtype, &frames, &pregap, pgtype, pgsub, &postgap) != 8)
+     throw MDFN_Error(0, _("Bad CHD track metadata: %s"), meta);
+   }
+   else if(trio_sscanf(meta, "TRACK:%d TYPE:%31s SUBTYPE:%31s FRAMES:%d", &tnum, type, subtype, &frames) != 4)
+    throw MDFN_Error(0, _("Bad CHD track metadata: %s"), meta);
+
+   if(tnum < 1 || tnum > 99 || frames < 0 || pregap < 0 || postgap < 0 || tinfo[tnum].present)
+    throw MDFN_Error(0, _("Bad CHD track metadata: %s"), meta);
+
+   for(format = 0; format < _DI_FORMAT_COUNT; format++)
+    if(!strcmp(type, CHD_Type_Strings[format]))
+     break;
+
+   if(!strcmp(type, "MODE2_FORM_MIX"))
+    format = DI_FORMAT_MODE2;
+
+   if(format == _DI_FORMAT_COUNT)
+    throw MDFN_Error(0, _("Unsupported CHD track type: %s"), type);
+
+   CDRFILE_TRACK_INFO *t = &Tracks[tnum];
+
+   t->DIFormat = format;
+   t->Format = (format == DI_FORMAT_AUDIO) ? CD_TRACK_FORMAT_AUDIO : CD_TRACK_FORMAT_DATA;
+
+   // Only raw P-W subchannel data is used; otherwise it's simulated, as for CUE sheets.
+   t->SubchannelMode = !strcmp(subtype, "RW_RAW") ? CDRF_SUBM_RW_RAW : CDRF_SUBM_NONE;
+   t->index[0] = -1;
+
+   tinfo[tnum].present = true;
+   tinfo[tnum].frames = frames;
+   tinfo[tnum].pregap = pregap;
+   tinfo[tnum].postgap = postgap;
+   tinfo[tnum].pregap_stored = (pgtype[0] == 'V');
+
+   if(tnum < FirstTrack)
+    FirstTrack = tnum;
+   if(tnum > LastTrack)
+    LastTrack = tnum;
+  }
+
+  meta_offset = next;
+ }
+
+ if(FirstTrack > LastTrack)
+  throw MDFN_Error(0, _("No tracks found!\n"));
+
+ NumTracks = 1 + LastTrack - FirstTrack;
+
+ //
+ // Lay the tracks out the same way as a CUE sheet with one file per track.  Each track's frames(including any stored pregap)
+ // start on a multiple of 4 frames in the CHD.
+ //
+ int32 RunningLBA = 0;
+ uint32 FrameOffset = 0;
+
+ for(int x = FirstTrack; x <= LastTrack; x++)
+ {
+  CDRFILE_TRACK_INFO *t = &Tracks[x];
+
+  if(!tinfo[x].present)
+   throw MDFN_Error(0, _("CHD is missing metadata for track %d."), x);
+
+  t->pregap_dv = tinfo[x].pregap_stored ? tinfo[x].pregap : 0;
+  t->pregap = tinfo[x].pregap_stored ? 0 : tinfo[x].pregap;
+  t->postgap = tinfo[x].postgap;
+
+  if((int32)tinfo[x].frames < t->pregap_dv)
+   throw MDFN_Error(0, _("Bad CHD track metadata for track %d."), x);
+
+  RunningLBA += t->pregap + t->pregap_dv;
+  t->LBA = RunningLBA;
+  t->sectors = tinfo[x].frames - t->pregap_dv;
+  t->FileOffset = FrameOffset;	// In frames, of the first stored(pregap) frame.
+  t->FirstFileInstance = 1;
+
+  RunningLBA += t->sectors + t->postgap;
+  FrameOffset += (tinfo[x].frames + 3) & ~3;
+ }
+
+ total_sectors = RunningLBA;
+}
+
+void CDAccess_CHD::Inflate(const uint8 *src, uint32 src_len, uint8 *dest, uint32 dest_len)
+{
+ z_stream zs;
+ int zr;
+
+ memset(&zs, 0, sizeof(zs));
+
+ if(inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+  throw MDFN_Error(0, _("zlib initialization failed."));
+
+ zs.next_in = (Bytef *)src;
+ zs.avail_in = src_len;
+ zs.next_out = dest;
+ zs.avail_out = dest_len;
+
+ zr = inflate(&zs, Z_FINISH);
+ inflateEnd(&zs);
+
+ if((zr != Z_STREAM_END && zr != Z_OK && zr != Z_BUF_ERROR) || zs.total_out != dest_len)
+  throw MDFN_Error(0, _("Error decompressing CHD hunk."));
+}
+
+void CDAccess_CHD::DecompressHunk(uint32 hunknum, uint8 *dest)
+{
+ const HunkMapEntry *e = &hunk_map[hunknum];
+
+ switch(e->comp)
+ {
+  case CHD_COMP_TYPE_0:
+  case CHD_COMP_TYPE_1:
+  case CHD_COMP_TYPE_2:
+  case CHD_COMP_TYPE_3:
+	comp_buf.resize(e->length);
+	ReadFile(e->offset, &comp_buf[0], e->length);
+
+	if(compressors[e->comp] == CHD_CODEC_ZLIB)
+	 Inflate(&comp_buf[0], e->length, dest, hunkbytes);
+	else if(compressors[e->comp] == CHD_CODEC_CD_ZLIB)
+	{
+	 // Sector data and subchannel data are deflated separately, and sectors flagged in the leading bitmap had their sync
+	 // header and ECC removed.
+	 const uint32 frames = frames_per_hunk;
+	 const uint32 ecc_bytes = (frames + 7) / 8;
+	 const uint32 complen_bytes = (hunkbytes < 65536) ? 2 : 3;
+	 const uint32 header_bytes = ecc_bytes + complen_bytes;
+	 uint32 complen_base;
+
+	 if(e->length < header_bytes)
+	  throw MDFN_Error(0, _("Error decompressing CHD hunk."));
+
+	 complen_base = (comp_buf[ecc_bytes] << 8) | comp_buf[ecc_bytes + 1];
+	 if(complen_bytes > 2)
+	  complen_base = (complen_base << 8) | comp_buf[ecc_bytes + 2];
+
+	 if(complen_base > e->length - header_bytes)
+	  throw MDFN_Error(0, _("Error decompressing CHD hunk."));
+
+	 cdzl_buf.resize(hunkbytes);
+	 Inflate(&comp_buf[header_bytes], complen_base, &cdzl_buf[0], frames * 2352);
+	 Inflate(&comp_buf[header_bytes + complen_base], e->length - header_bytes - complen_base, &cdzl_buf[frames * 2352], frames * 96);
+
+	 for(uint32 f = 0; f < frames; f++)
+	 {
+	  uint8 *sector = &dest[f * CD_FRAME_SIZE];
+
+	  memcpy(sector, &cdzl_buf[f * 2352], 2352);
+	  memcpy(sector + 2352, &cdzl_buf[frames * 2352 + f * 96], 96);
+
+	  if(comp_buf[f >> 3] & (1 << (f & 7)))
+	  {
+	   memcpy(sector, CD_Sync_Header, sizeof(CD_Sync_Header));
+	   generate_mode1_ecc(sector);
+	  }
+	 }
+	}
+	break;
+
+  case CHD_COMP_NONE:
+  case CHD_COMP_NONE_NOCRC:
+	ReadFile(e->offset, dest, hunkbytes);
+	break;
+
+  case CHD_COMP_ZERO:
+	memset(dest, 0, hunkbytes);
+	break;
+
+  case CHD_COMP_SELF:
+	if(e->offset >= hunknum)	// LoadMap() already rejects these.
+	 throw MDFN_Error(0, _("CHD hunk map is corrupt."));
+
+	// Decode straight into dest rather than through GetHunk(), which could evict dest's cache slot.
+	DecompressHunk(e->offset, dest);
+	return;
+
+  default:
+	throw MDFN_Error(0, _("CHD hunk %u refers to a parent CHD, which is not supported."), hunknum);
+ }
+
+ if(e->comp != CHD_COMP_NONE_NOCRC && e->comp != CHD_COMP_ZERO && CRC16(dest, hunkbytes) != e->crc)
+  throw MDFN_Error(0, _("CRC mismatch in CHD hunk %u."), hunknum);
+}
+
+const uint8 *CDAccess_CHD::GetHunk(uint32 hunknum)
+{
+ unsigned victim = 0;
+
+ hunk_cache_clock++;
+
+ for(unsigned i = 0; i < hunk_cache_num.size(); i++)
+ {
+  if(hunk_cache_num[i] == hunknum)
+  {
+   hunk_cache_used[i] = hunk_cache_clock;
+   return(&hunk_cache[i * hunkbytes]);
+  }
+
+  if(hunk_cache_used[i] < hunk_cache_used[victim])
+   victim = i;
+ }
+
+ hunk_cache_num[victim] = ~0U;	// In case decompression throws.
+ DecompressHunk(hunknum, &hunk_cache[victim * hunkbytes]);
+ hunk_cache_num[victim] = hunknum;
+ hunk_cache_used[victim] = hunk_cache_clock;
+
+ return(&hunk_cache[victim * hunkbytes]);
+}
+
+void CDAccess_CHD::Read_Raw_Sector(uint8 *buf, int32 lba)
+{
+ const int32 track = FindTrack(lba);
+
+ memset(buf + 2352, 0, 96);
+ MakeSubPQ(lba, buf + 2352);
+
+ if(!track)
+  throw(MDFN_Error(0, _("Could not find track for sector %u!"), lba));
+
+ CDRFILE_TRACK_INFO *ct = &Tracks[track];
+
+ // Pregap and postgap that aren't stored in the CHD read as zeroes.
+ if(lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+ {
+  memset(buf, 0, 2352);
+  return;
+ }
+
+ const uint32 frame = ct->FileOffset + (lba - (ct->LBA - ct->pregap_dv));
+ const uint8 *src = GetHunk(frame / frames_per_hunk) + (frame % frames_per_hunk) * CD_FRAME_SIZE;
+
+ switch(ct->DIFormat)
+ {
+  case DI_FORMAT_AUDIO:
+	// CHD stores audio big-endian.
+	for(int i = 0; i < 2352; i += 2)
+	{
+	 buf[i + 0] = src[i + 1];
+	 buf[i + 1] = src[i + 0];
+	}
+	break;
+
+  case DI_FORMAT_MODE1:
+	memcpy(buf + 12 + 3 + 1, src, 2048);
+	EncodeMode1Sector(lba, buf);
+	break;
+
+  case DI_FORMAT_MODE1_RAW:
+  case DI_FORMAT_MODE2_RAW:
+	memcpy(buf, src, 2352);
+	break;
+
+  case DI_FORMAT_MODE2:
+	memcpy(buf + 16, src, 2336);
+	encode_mode2_sector(lba + 150, buf);
+	break;
+
+  case DI_FORMAT_MODE2_FORM1:
+	memcpy(buf + 24, src, 2048);
+	break;
+
+  case DI_FORMAT_MODE2_FORM2:
+	memcpy(buf + 24, src, 2324);
+	break;
+ }
+
+ if(ct->SubchannelMode)
+  memcpy(buf + 2352, src + 2352, 96);
+}
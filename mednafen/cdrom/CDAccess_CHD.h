@@ -0,0 +1,57 @@
+#ifndef __MDFN_CDACCESS_CHD_H
+#define __MDFN_CDACCESS_CHD_H
+
+#include <vector>
+
+#include "CDAccess_Image.h"
+
+// MAME "compressed hunks of data"(CHD v5) CD images.  Only zlib-compressed hunks("zlib" and "cdzl" codecs) can be decoded.  The
+// track layout is translated into CDAccess_Image's, which then takes care of the TOC and simulated subchannel data.
+//
+// Like every CDAccess, this is only ever called from CDIF's read thread, so that's where the inflating happens.
+class CDAccess_CHD : public CDAccess_Image
+{
+ public:
+
+ CDAccess_CHD(const char *path);
+ virtual ~CDAccess_CHD();
+
+ virtual void Read_Raw_Sector(uint8 *buf, int32 lba);
+
+ private:
+
+ struct HunkMapEntry
+ {
+  uint8 comp;
+  uint32 length;
+  uint64 offset;
+  uint16 crc;
+ };
+
+ FILE *fp;
+
+ uint32 hunkbytes;
+ uint32 hunkcount;
+ uint32 frames_per_hunk;
+ uint32 compressors[4];
+ std::vector<HunkMapEntry> hunk_map;
+
+ std::vector<uint8> comp_buf;
+ std::vector<uint8> cdzl_buf;
+
+ // LRU cache of decompressed hunks, sized to cover CDIF's read-ahead window.
+ std::vector<uint8> hunk_cache;
+ std::vector<uint32> hunk_cache_num;
+ std::vector<uint32> hunk_cache_used;
+ uint32 hunk_cache_clock;
+
+ void ReadFile(uint64 offset, uint8 *dest, uint32 len);
+ void LoadMap(uint64 map_offset, uint32 unitbytes);
+ void LoadTOC(uint64 meta_offset);
+
+ const uint8 *GetHunk(uint32 hunknum);
+ void DecompressHunk(uint32 hunknum, uint8 *dest);
+ void Inflate(const uint8 *src, uint32 src_len, uint8 *dest, uint32 dest_len);
+};
+
+#endif
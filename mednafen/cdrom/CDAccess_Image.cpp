@@ -45,6 +45,11 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "../include/trio/trio.h"
 
 #include "../general.h"
@@ -59,26 +64,6 @@
 
 using namespace CDUtility;
 
-enum
-{
- CDRF_SUBM_NONE = 0,
- CDRF_SUBM_RW = 1,
- CDRF_SUBM_RW_RAW = 2
-};
-
-// Disk-image(rip) track/sector formats
-enum
-{
- DI_FORMAT_AUDIO       = 0x00,
- DI_FORMAT_MODE1       = 0x01,
- DI_FORMAT_MODE1_RAW   = 0x02,
- DI_FORMAT_MODE2       = 0x03,
- DI_FORMAT_MODE2_FORM1 = 0x04,
- DI_FORMAT_MODE2_FORM2 = 0x05,
- DI_FORMAT_MODE2_RAW   = 0x06,
- _DI_FORMAT_COUNT
-};
-
 static const int32 DI_Size_Table[7] =
 {
  2352, // Audio
@@ -162,8 +147,8 @@ uint32 CDAccess_Image::GetSectorCount(CDRFILE_TRACK_INFO *track)
 {
  if(track->DIFormat == DI_FORMAT_AUDIO)
  {
-  if(track->AReader)
-   return(((track->AReader->FrameCount() * 4) - track->FileOffset) / 2352);
+  if(track->AFile)
+   return(((track->AFile->FrameCount * 4) - track->FileOffset) / 2352);
   else
   {
    struct stat stat_buf;
@@ -201,15 +186,121 @@ CDAccess_Image::~CDAccess_Image()
 
   if(this_track->FirstFileInstance)
   {
-   if(Tracks[track].AReader)
+   #ifdef HAVE_MMAP
+   if(this_track->MapBase)
    {
-    delete Tracks[track].AReader;
-    Tracks[track].AReader = NULL;
+    munmap(this_track->MapBase, this_track->MapSize);
+    this_track->MapBase = NULL;
    }
-   else if(this_track->fp)
+   #endif
+
+   if(this_track->fp)
     fclose(this_track->fp);
   }
  }
+
+ for(unsigned i = 0; i < AudioFiles.size(); i++)
+ {
+  CloseAudioFile(AudioFiles[i]);
+  delete AudioFiles[i]->SeekIndex;
+  delete AudioFiles[i];
+ }
+ AudioFiles.clear();
+}
+
+// Only checks that the file can be decoded and gets its length; the decoder itself is set up by GetAudioReader() on first use.
+CDRFILE_AUDIO_FILE *CDAccess_Image::AddAudioFile(const std::string &path)
+{
+ CDRFILE_AUDIO_FILE *af;
+ FILE *fp;
+ int64 frame_count;
+
+ if(NULL == (fp = fopen(path.c_str(), "rb")))
+ {
+  ErrnoHolder ene(errno);
+
+  throw(MDFN_Error(ene.Errno(), _("Could not open referenced file \"%s\": %s\n"), path.c_str(), ene.StrError()));
+ }
+
+ frame_count = AR_ProbeFrameCount(fp);
+ fclose(fp);
+
+ if(frame_count < 0)
+  throw(MDFN_Error(0, _("Unsupported audio track file format: %s\n"), path.c_str()));
+
+ af = new CDRFILE_AUDIO_FILE;
+ af->path = path;
+ af->fp = NULL;
+ af->AReader = NULL;
+ af->FrameCount = frame_count;
+ af->SeekIndex = new AR_SeekIndex;
+ af->LastUsed = 0;
+
+ AudioFiles.push_back(af);
+
+ return(af);
+}
+
+AudioReader *CDAccess_Image::GetAudioReader(CDRFILE_AUDIO_FILE *af)
+{
+ af->LastUsed = ++AudioFileClock;
+
+ if(af->AReader)
+  return(af->AReader);
+
+ // Keep the number of open decoders(and their decoded-block caches) down on discs with lots of audio tracks.
+ for(;;)
+ {
+  CDRFILE_AUDIO_FILE *lru = NULL;
+  unsigned open_count = 0;
+
+  for(unsigned i = 0; i < AudioFiles.size(); i++)
+  {
+   if(AudioFiles[i]->AReader)
+   {
+    open_count++;
+    if(!lru || AudioFiles[i]->LastUsed < lru->LastUsed)
+     lru = AudioFiles[i];
+   }
+  }
+
+  if(open_count < MaxOpenAudioFiles)
+   break;
+
+  CloseAudioFile(lru);
+ }
+
+ if(NULL == (af->fp = fopen(af->path.c_str(), "rb")))
+ {
+  ErrnoHolder ene(errno);
+
+  throw(MDFN_Error(ene.Errno(), _("Could not open referenced file \"%s\": %s\n"), af->path.c_str(), ene.StrError()));
+ }
+
+ if(!(af->AReader = AR_Open(af->fp, af->path.c_str(), af->SeekIndex)))
+ {
+  fclose(af->fp);
+  af->fp = NULL;
+
+  throw(MDFN_Error(0, _("Unsupported audio track file format: %s\n"), af->path.c_str()));
+ }
+
+ return(af->AReader);
+}
+
+void CDAccess_Image::CloseAudioFile(CDRFILE_AUDIO_FILE *af)
+{
+ if(af->AReader)
+ {
+  delete af->AReader;
+  af->AReader = NULL;
+ }
+
+ if(af->fp)
+ {
+  fclose(af->fp);
+  af->fp = NULL;
+ }
 }
 
 void CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const char *filename, const char *binoffset, const char *msfoffset, const char *length)
@@ -223,21 +314,15 @@ void CDAccess_Image::ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int t
 
  efn = MDFN_EvalFIP(base_dir, filename);
 
- if(NULL == (track->fp = fopen(efn.c_str(), "rb")))
+ if(strlen(filename) >= 4 && !strcasecmp(filename + strlen(filename) - 4, ".wav"))
+  track->AFile = AddAudioFile(efn);
+ else if(NULL == (track->fp = fopen(efn.c_str(), "rb")))
  {
   ErrnoHolder ene(errno);
 
   throw MDFN_Error(ene.Errno(), _("Could not open referenced file \"%s\": %s\n"), efn.c_str(), ene.StrError());
  }
 
- if(strlen(filename) >= 4 && !strcasecmp(filename + strlen(filename) - 4, ".wav"))
- {
-  track->AReader = AR_Open(track->fp);
-
-  if(!track->AReader)
-   throw MDFN_Error(0, "TODO ERROR");
- }
-
  sector_mult = DI_Size_Table[track->DIFormat];
 
  if(track->SubchannelMode)
@@ -496,15 +581,16 @@ void CDAccess_Image::ImageOpen(const char *path)
 
      std::string efn = MDFN_EvalFIP(base_dir, args[0]);
 
-     if(NULL == (TmpTrack.fp = fopen(efn.c_str(), "rb")))
-     {
-      ErrnoHolder ene(errno);
-
-      throw(MDFN_Error(ene.Errno(), _("Could not open referenced file \"%s\": %s\n"), efn.c_str(), ene.StrError()));
-     }
      TmpTrack.FirstFileInstance = 1;
      if(!strcasecmp(args[1], "BINARY"))
      {
+      if(NULL == (TmpTrack.fp = fopen(efn.c_str(), "rb")))
+      {
+       ErrnoHolder ene(errno);
+
+       throw(MDFN_Error(ene.Errno(), _("Could not open referenced file \"%s\": %s\n"), efn.c_str(), ene.StrError()));
+      }
+
       //TmpTrack.Format = TRACK_FORMAT_DATA;
       //struct stat stat_buf;
       //fstat(fileno(TmpTrack.fp), &stat_buf);
@@ -513,11 +599,7 @@ void CDAccess_Image::ImageOpen(const char *path)
      else if(!strcasecmp(args[1], "OGG") || !strcasecmp(args[1], "VORBIS") || !strcasecmp(args[1], "WAVE") || !strcasecmp(args[1], "WAV") || !strcasecmp(args[1], "PCM")
 	|| !strcasecmp(args[1], "MPC") || !strcasecmp(args[1], "MP+"))
      {
-      TmpTrack.AReader = AR_Open(TmpTrack.fp);
-      if(!TmpTrack.AReader)
-      {
-       throw(MDFN_Error(0, _("Unsupported audio track file format: %s\n"), args[0]));
-      }
+      TmpTrack.AFile = AddAudioFile(efn);
      }
      else
      {
@@ -690,92 +772,199 @@ void CDAccess_Image::ImageOpen(const char *path)
  } // end to track loop
 
  total_sectors = RunningLBA;
+
+ for(int x = FirstTrack; x < (FirstTrack + NumTracks); x++)
+ {
+  if(Tracks[x].FirstFileInstance)
+   MapTrackFile(&Tracks[x]);
+  else if(x > FirstTrack)
+  {
+   Tracks[x].MapBase = Tracks[x - 1].MapBase;
+   Tracks[x].MapSize = Tracks[x - 1].MapSize;
+  }
+ }
+}
+
+#ifdef HAVE_MMAP
+static long PageMask;	// Set by MapTrackFile() before any track is mapped.
+#endif
+
+// Maps a raw track file into memory so sectors can be copied straight out of the page cache, which is also shared with any other
+// process that has the same image open.  Falls back to stdio(MapBase left NULL) if the file can't be mapped.
+void CDAccess_Image::MapTrackFile(CDRFILE_TRACK_INFO *track)
+{
+ track->MapBase = NULL;
+ track->MapSize = 0;
+
+ #ifdef HAVE_MMAP
+ struct stat stat_buf;
+ void *base;
+
+ if(!track->fp)
+  return;
+
+ PageMask = sysconf(_SC_PAGESIZE) - 1;
+
+ if(fstat(fileno(track->fp), &stat_buf) || stat_buf.st_size <= 0 || (uint64)stat_buf.st_size != (size_t)stat_buf.st_size)
+  return;
+
+ base = mmap(NULL, stat_buf.st_size, PROT_READ, MAP_SHARED, fileno(track->fp), 0);
+
+ if(base == MAP_FAILED)
+  return;
+
+ // No access pattern advice for the whole mapping: CD access seeks a lot(data seeks, looping CD-DA), so read-ahead
+ // is requested per read instead, by HintReadSectors().
+
+ track->MapBase = (uint8 *)base;
+ track->MapSize = stat_buf.st_size;
+ #endif
+}
+
+// Reads "len" bytes at file offset "pos" of the track's file.  Bytes past the end of the file read as 0.
+void CDAccess_Image::ReadTrackData(CDRFILE_TRACK_INFO *track, long pos, uint8 *dest, size_t len)
+{
+ if(track->MapBase)
+ {
+  size_t avail = 0;
+
+  if(pos >= 0 && (size_t)pos < track->MapSize)
+   avail = std::min<size_t>(len, track->MapSize - pos);
+
+  if(avail)
+   memcpy(dest, track->MapBase + pos, avail);
+  memset(dest + avail, 0, len - avail);
+ }
+ else
+ {
+  fseek(track->fp, pos, SEEK_SET);
+  fread(dest, 1, len, track->fp);
+ }
 }
 
-CDAccess_Image::CDAccess_Image(const char *path)
+void CDAccess_Image::HintReadSectors(int32 lba, int32 count)
+{
+ #ifdef HAVE_MMAP
+ const int32 track = FindTrack(lba);
+
+ if(!track)
+  return;
+
+ CDRFILE_TRACK_INFO *ct = &Tracks[track];
+
+ // Same range Read_Raw_Sector() reads from the file: the stored pregap, then the track proper.
+ if(!ct->MapBase || lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+  return;
+
+ const long sector_size = DI_Size_Table[ct->DIFormat] + (ct->SubchannelMode ? 96 : 0);
+ long start = ct->FileOffset + (lba - ct->LBA) * sector_size;
+ long end = start + std::min(count, ct->LBA + ct->sectors - lba) * sector_size;
+
+ start &= ~PageMask;
+
+ if((size_t)end > ct->MapSize)
+  end = ct->MapSize;
+
+ if(start < end)
+  madvise(ct->MapBase + start, end - start, MADV_WILLNEED);
+ #endif
+}
+
+CDAccess_Image::CDAccess_Image(const char *path) : SkipECC(MDFN_GetSettingB("cdrom.skip_ecc")), FindTrackCache(0), SubQ_Track(0), AudioFileClock(0)
 {
  ImageOpen(path);
 }
 
+CDAccess_Image::CDAccess_Image() : SkipECC(MDFN_GetSettingB("cdrom.skip_ecc")), FindTrackCache(0), SubQ_Track(0), AudioFileClock(0)
+{
+ NumTracks = 0;
+ FirstTrack = 1;
+ LastTrack = 0;
+ total_sectors = 0;
+ memset(Tracks, 0, sizeof(Tracks));
+}
+
+void CDAccess_Image::EncodeMode1Sector(int32 lba, uint8 *buf)
+{
+ if(SkipECC)
+  encode_mode1_sector_no_ecc(lba + 150, buf);
+ else
+  encode_mode1_sector(lba + 150, buf);
+}
+
 void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 {
-  bool TrackFound = FALSE;
-  uint8 SimuQ[0xC];
+  const int32 track = FindTrack(lba);
 
   memset(buf + 2352, 0, 96);
 
   MakeSubPQ(lba, buf + 2352);
 
-  subq_deinterleave(buf + 2352, SimuQ);
-
-  for(int32 track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+  if(!track)
   {
-   CDRFILE_TRACK_INFO *ct = &Tracks[track];
+   throw(MDFN_Error(0, _("Could not find track for sector %u!"), lba));
+  }
 
-   if(lba >= (ct->LBA - ct->pregap_dv - ct->pregap) && lba < (ct->LBA + ct->sectors + ct->postgap))
+  CDRFILE_TRACK_INFO *ct = &Tracks[track];
+
+  // Handle pregap and postgap reading
+  if(lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+  {
+   //printf("Pre/post-gap read, LBA=%d(LBA-track_start_LBA=%d)\n", lba, lba - ct->LBA);
+   memset(buf, 0, 2352);	// Null sector data, per spec
+  }
+  else
+  {
+   if(ct->AFile)
    {
-    TrackFound = TRUE;
+    int16 AudioBuf[588 * 2];
+    int frames_read = GetAudioReader(ct->AFile)->Read((ct->FileOffset / 4) + (lba - ct->LBA) * 588, AudioBuf, 588);
+
+    ct->LastSamplePos += frames_read;
 
-    // Handle pregap and postgap reading
-    if(lba < (ct->LBA - ct->pregap_dv) || lba >= (ct->LBA + ct->sectors))
+    if(frames_read < 0 || frames_read > 588)	// This shouldn't happen.
     {
-     //printf("Pre/post-gap read, LBA=%d(LBA-track_start_LBA=%d)\n", lba, lba - ct->LBA);
-     memset(buf, 0, 2352);	// Null sector data, per spec
+     printf("Error: frames_read out of range: %d\n", frames_read);
+     frames_read = 0;
     }
-    else
-    {
-     if(ct->AReader)
-     {
-      int16 AudioBuf[588 * 2];
-      int frames_read = ct->AReader->Read((ct->FileOffset / 4) + (lba - ct->LBA) * 588, AudioBuf, 588);
 
-      ct->LastSamplePos += frames_read;
+    if(frames_read < 588)
+     memset((uint8 *)AudioBuf + frames_read * 2 * sizeof(int16), 0, (588 - frames_read) * 2 * sizeof(int16));
 
-      if(frames_read < 0 || frames_read > 588)	// This shouldn't happen.
-      {
-       printf("Error: frames_read out of range: %d\n", frames_read);
-       frames_read = 0;
-      }
-
-      if(frames_read < 588)
-       memset((uint8 *)AudioBuf + frames_read * 2 * sizeof(int16), 0, (588 - frames_read) * 2 * sizeof(int16));
-
-      for(int i = 0; i < 588 * 2; i++)
-       MDFN_en16lsb(buf + i * 2, AudioBuf[i]);
-     }
-     else	// Binary, woo.
-     {
-      long SeekPos = ct->FileOffset;
-      long LBARelPos = lba - ct->LBA;
-
-      SeekPos += LBARelPos * DI_Size_Table[ct->DIFormat];
+    for(int i = 0; i < 588 * 2; i++)
+     MDFN_en16lsb(buf + i * 2, AudioBuf[i]);
+   }
+   else	// Binary, woo.
+   {
+    long SeekPos = ct->FileOffset;
+    long LBARelPos = lba - ct->LBA;
 
-      if(ct->SubchannelMode)
-       SeekPos += 96 * (lba - ct->LBA);
+    SeekPos += LBARelPos * DI_Size_Table[ct->DIFormat];
 
-      fseek(ct->fp, SeekPos, SEEK_SET);
+    if(ct->SubchannelMode)
+     SeekPos += 96 * (lba - ct->LBA);
 
-      switch(ct->DIFormat)
-      {
+    switch(ct->DIFormat)
+    {
 	case DI_FORMAT_AUDIO:
-		fread(buf, 1, 2352, ct->fp);
+		ReadTrackData(ct, SeekPos, buf, 2352);
 
 		if(ct->RawAudioMSBFirst)
 		 Endian_A16_Swap(buf, 588 * 2);
 		break;
 
 	case DI_FORMAT_MODE1:
-		fread(buf + 12 + 3 + 1, 1, 2048, ct->fp);
-		encode_mode1_sector(lba + 150, buf);
+		ReadTrackData(ct, SeekPos, buf + 12 + 3 + 1, 2048);
+		EncodeMode1Sector(lba, buf);
 		break;
 
 	case DI_FORMAT_MODE1_RAW:
 	case DI_FORMAT_MODE2_RAW:
-		fread(buf, 1, 2352, ct->fp);
+		ReadTrackData(ct, SeekPos, buf, 2352);
 		break;
 
 	case DI_FORMAT_MODE2:
-		fread(buf + 16, 1, 2336, ct->fp);
+		ReadTrackData(ct, SeekPos, buf + 16, 2336);
 		encode_mode2_sector(lba + 150, buf);
 		break;
 
@@ -783,68 +972,123 @@ void CDAccess_Image::Read_Raw_Sector(uint8 *buf, int32 lba)
 	// FIXME: M2F1, M2F2, does sub-header come before or after user data(standards say before, but I wonder
 	// about cdrdao...).
 	case DI_FORMAT_MODE2_FORM1:
-		fread(buf + 24, 1, 2048, ct->fp);
+		ReadTrackData(ct, SeekPos, buf + 24, 2048);
 		//encode_mode2_form1_sector(lba + 150, buf);
 		break;
 
 	case DI_FORMAT_MODE2_FORM2:
-		fread(buf + 24, 1, 2324, ct->fp);
+		ReadTrackData(ct, SeekPos, buf + 24, 2324);
 		//encode_mode2_form2_sector(lba + 150, buf);
 		break;
 
-      }
+    }
 
-      if(ct->SubchannelMode)
-       fread(buf + 2352, 1, 96, ct->fp);
-     }
-    } // end if audible part of audio track read.
-    break;
-   } // End if LBA is in range
-  } // end track search loop
+    if(ct->SubchannelMode)
+     ReadTrackData(ct, SeekPos + DI_Size_Table[ct->DIFormat], buf + 2352, 96);
+   }
+  } // end if audible part of audio track read.
+}
+
+int32 CDAccess_Image::FindTrack(int32 lba)
+{
+ const int32 cached = FindTrackCache;
+
+ if(cached && lba >= (Tracks[cached].LBA - Tracks[cached].pregap_dv - Tracks[cached].pregap) && lba < (Tracks[cached].LBA + Tracks[cached].sectors + Tracks[cached].postgap))
+  return(cached);
+
+ // Tracks are in LBA order; find the last one starting(pregap included) at or before "lba".
+ int32 lo = FirstTrack;
+ int32 hi = FirstTrack + NumTracks - 1;
+ int32 track = 0;
 
-  if(!TrackFound)
+ while(lo <= hi)
+ {
+  const int32 mid = (lo + hi) >> 1;
+
+  if(lba >= (Tracks[mid].LBA - Tracks[mid].pregap_dv - Tracks[mid].pregap))
   {
-   throw(MDFN_Error(0, _("Could not find track for sector %u!"), lba));
+   track = mid;
+   lo = mid + 1;
   }
+  else
+   hi = mid - 1;
+ }
+
+ if(!track || lba >= (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
+  return(0);
 
+ FindTrackCache = track;
+
+ return(track);
 }
 
-void CDAccess_Image::MakeSubPQ(int32 lba, uint8 *SubPWBuf)
+// Steps a BCD MSF address one sector forward, or back.
+static INLINE void MSF_BCD_Step(uint8 *msf, bool back)
 {
- uint8 buf[0xC];
- int32 track;
- uint32 lba_relative;
- uint32 ma, sa, fa;
- uint32 m, s, f;
- uint8 pause_or = 0x00;
- bool track_found = FALSE;
+ const uint8 wrap[3] = { 0x00, 0x59, 0x74 };
 
- for(track = FirstTrack; track < (FirstTrack + NumTracks); track++)
+ for(int i = 2; i >= 0; i--)
  {
-  if(lba >= (Tracks[track].LBA - Tracks[track].pregap_dv - Tracks[track].pregap) && lba < (Tracks[track].LBA + Tracks[track].sectors + Tracks[track].postgap))
+  if(back)
   {
-   track_found = TRUE;
-   break;
+   if(msf[i] != 0x00 || !i)
+   {
+    msf[i] -= ((msf[i] & 0xF) == 0x0) ? 7 : 1;
+    break;
+   }
+
+   msf[i] = wrap[i];
+  }
+  else
+  {
+   if(msf[i] != wrap[i] || !i)
+   {
+    msf[i] += ((msf[i] & 0xF) == 0x9) ? 7 : 1;
+    break;
+   }
+
+   msf[i] = 0x00;
   }
  }
+}
+
+void CDAccess_Image::MakeSubPQ(int32 lba, uint8 *SubPWBuf)
+{
+ uint8 *buf = SubQ_Buf;
+ int32 track;
+ uint8 pause_or = 0x00;
 
- //printf("%d %d\n", Tracks[1].LBA, Tracks[1].sectors);
+ track = FindTrack(lba);
 
- if(!track_found)
+ if(!track)
  {
   printf("MakeSubPQ error for sector %u!", lba);
   track = FirstTrack;
  }
 
- lba_relative = abs((int32)lba - Tracks[track].LBA);
+ if(track == SubQ_Track && lba == (SubQ_LBA + 1))
+ {
+  // Next sector in the same track; the track relative address counts down to INDEX 01 in the pregap, and up after it.
+  MSF_BCD_Step(&buf[3], lba <= Tracks[track].LBA);
+  MSF_BCD_Step(&buf[7], false);
+ }
+ else
+ {
+  const uint32 lba_relative = abs((int32)lba - Tracks[track].LBA);
+
+  // Track relative MSF address
+  buf[3] = U8_to_BCD(lba_relative / 75 / 60);
+  buf[4] = U8_to_BCD((lba_relative / 75) % 60);
+  buf[5] = U8_to_BCD(lba_relative % 75);
 
- f = (lba_relative % 75);
- s = ((lba_relative / 75) % 60);
- m = (lba_relative / 75 / 60);
+  // Absolute MSF address
+  buf[7] = U8_to_BCD((lba + 150) / 75 / 60);
+  buf[8] = U8_to_BCD(((lba + 150) / 75) % 60);
+  buf[9] = U8_to_BCD((lba + 150) % 75);
+ }
 
- fa = (lba + 150) % 75;
- sa = ((lba + 150) / 75) % 60;
- ma = ((lba + 150) / 75 / 60);
+ SubQ_LBA = lba;
+ SubQ_Track = track;
 
  uint8 adr = 0x1; // Q channel data encodes position
  uint8 control = (Tracks[track].Format == CD_TRACK_FORMAT_AUDIO) ? 0x00 : 0x04;
@@ -873,8 +1117,6 @@ void CDAccess_Image::MakeSubPQ(int32 lba, uint8 *SubPWBuf)
   }
  }
 
-
- memset(buf, 0, 0xC);
  buf[0] = (adr << 0) | (control << 4);
  buf[1] = U8_to_BCD(track);
 
@@ -883,22 +1125,25 @@ void CDAccess_Image::MakeSubPQ(int32 lba, uint8 *SubPWBuf)
  else
   buf[2] = U8_to_BCD(0x01);
 
- // Track relative MSF address
- buf[3] = U8_to_BCD(m);
- buf[4] = U8_to_BCD(s);
- buf[5] = U8_to_BCD(f);
-
  buf[6] = 0; // Zerroooo
 
- // Absolute MSF address
- buf[7] = U8_to_BCD(ma);
- buf[8] = U8_to_BCD(sa);
- buf[9] = U8_to_BCD(fa);
-
  subq_generate_checksum(buf);
 
- for(int i = 0; i < 96; i++)
-  SubPWBuf[i] |= (((buf[i >> 3] >> (7 - (i & 0x7))) & 1) ? 0x40 : 0x00) | pause_or;
+ // Bit 7 - n of Q byte i goes to bit 6 of interleaved subchannel byte i * 8 + n.
+ for(int i = 0; i < 0xC; i++)
+ {
+  const uint8 q = buf[i];
+  uint8 *pw = SubPWBuf + i * 8;
+
+  pw[0] |= ((q >> 1) & 0x40) | pause_or;
+  pw[1] |= ((q >> 0) & 0x40) | pause_or;
+  pw[2] |= ((q << 1) & 0x40) | pause_or;
+  pw[3] |= ((q << 2) & 0x40) | pause_or;
+  pw[4] |= ((q << 3) & 0x40) | pause_or;
+  pw[5] |= ((q << 4) & 0x40) | pause_or;
+  pw[6] |= ((q << 5) & 0x40) | pause_or;
+  pw[7] |= ((q << 6) & 0x40) | pause_or;
+ }
 }
 
 void CDAccess_Image::Read_TOC(TOC *toc)
@@ -1,7 +1,42 @@
 #ifndef __MDFN_CDACCESS_IMAGE_H
 #define __MDFN_CDACCESS_IMAGE_H
 
+#include <vector>
+
 class AudioReader;
+struct AR_SeekIndex;
+
+// A compressed(or WAV) audio track file.  The decoder is only set up when the file is first read from, and is closed again
+// when too many others are open.
+struct CDRFILE_AUDIO_FILE
+{
+ std::string path;
+ FILE *fp;		// NULL while closed.
+ AudioReader *AReader;	// NULL while closed.
+ int64 FrameCount;	// From AR_ProbeFrameCount() at load time.
+ AR_SeekIndex *SeekIndex;	// Kept while the decoder is closed, so reopening it doesn't mean another scan of the file.
+ uint32 LastUsed;
+};
+
+enum
+{
+ CDRF_SUBM_NONE = 0,
+ CDRF_SUBM_RW = 1,
+ CDRF_SUBM_RW_RAW = 2
+};
+
+// Disk-image(rip) track/sector formats
+enum
+{
+ DI_FORMAT_AUDIO       = 0x00,
+ DI_FORMAT_MODE1       = 0x01,
+ DI_FORMAT_MODE1_RAW   = 0x02,
+ DI_FORMAT_MODE2       = 0x03,
+ DI_FORMAT_MODE2_FORM1 = 0x04,
+ DI_FORMAT_MODE2_FORM2 = 0x05,
+ DI_FORMAT_MODE2_RAW   = 0x06,
+ _DI_FORMAT_COUNT
+};
 
 struct CDRFILE_TRACK_INFO
 {
@@ -19,6 +54,8 @@ struct CDRFILE_TRACK_INFO
 
 	int32 sectors;	// Not including pregap sectors!
         FILE *fp;
+	uint8 *MapBase;		// Whole track file when it could be mmap()'d, else NULL.  Shared by all tracks in the file.
+	size_t MapSize;
 	bool FirstFileInstance;
 	bool RawAudioMSBFirst;
 	long FileOffset;
@@ -26,7 +63,7 @@ struct CDRFILE_TRACK_INFO
 
 	uint32 LastSamplePos;
 
-	AudioReader *AReader;
+	CDRFILE_AUDIO_FILE *AFile;	// NULL unless the track is in a compressed/WAV audio file, in which case fp is NULL.
 };
 
 class CDAccess_Image : public CDAccess
@@ -38,12 +75,18 @@ class CDAccess_Image : public CDAccess
 
  virtual void Read_Raw_Sector(uint8 *buf, int32 lba);
 
+ virtual void HintReadSectors(int32 lba, int32 count);
+
  virtual void Read_TOC(CDUtility::TOC *toc);
 
  virtual bool Is_Physical(void);
 
  virtual void Eject(bool eject_status);
- private:
+
+ protected:
+
+ // For subclasses that fill in the track layout(and total_sectors) themselves.
+ CDAccess_Image();
 
  int32 NumTracks;
  int32 FirstTrack;
@@ -53,11 +96,43 @@ class CDAccess_Image : public CDAccess
 
  std::string base_dir;
 
- void ImageOpen(const char *path);
+ // "cdrom.skip_ecc": cooked MODE1 sectors get a valid EDC but no synthesized ECC, which nothing in the emulated
+ // drive path looks at.
+ bool SkipECC;
+
+ void EncodeMode1Sector(int32 lba, uint8 *buf);
+
+ // Returns the track whose range(pregap and postgap included) contains "lba", or 0 if there isn't one.
+ int32 FindTrack(int32 lba);
 
  // MakeSubPQ will OR the simulated P and Q subchannel data into SubPWBuf.
  void MakeSubPQ(int32 lba, uint8 *SubPWBuf);
 
+ private:
+
+ // Last track FindTrack() found; nearly every read is in the same track as the one before it.
+ int32 FindTrackCache;
+
+ // Q subchannel data MakeSubPQ() generated last, so that for the next sector in the same track only the MSF addresses have to
+ // be stepped.
+ int32 SubQ_LBA;
+ int32 SubQ_Track;
+ uint8 SubQ_Buf[0xC];
+
+ enum { MaxOpenAudioFiles = 4 };
+
+ std::vector<CDRFILE_AUDIO_FILE *> AudioFiles;
+ uint32 AudioFileClock;
+
+ CDRFILE_AUDIO_FILE *AddAudioFile(const std::string &path);
+ AudioReader *GetAudioReader(CDRFILE_AUDIO_FILE *af);
+ void CloseAudioFile(CDRFILE_AUDIO_FILE *af);
+
+ void ImageOpen(const char *path);
+
+ void MapTrackFile(CDRFILE_TRACK_INFO *track);
+ void ReadTrackData(CDRFILE_TRACK_INFO *track, long pos, uint8 *dest, size_t len);
+
  void ParseTOCFileLineInfo(CDRFILE_TRACK_INFO *track, const int tracknum, const char *filename, const char *binoffset, const char *msfoffset, const char *length);
  uint32 GetSectorCount(CDRFILE_TRACK_INFO *track);
 };
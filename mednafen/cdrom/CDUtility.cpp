@@ -89,6 +89,20 @@ void encode_mode1_sector(uint32 aba, uint8 *sector_data)
  lec_encode_mode1_sector(aba, sector_data);
 }
 
+void encode_mode1_sector_no_ecc(uint32 aba, uint8 *sector_data)
+{
+ CDUtility_Init();
+
+ lec_encode_mode1_sector_no_ecc(aba, sector_data);
+}
+
+void generate_mode1_ecc(uint8 *sector_data)
+{
+ CDUtility_Init();
+
+ lec_generate_mode1_ecc(sector_data);
+}
+
 void encode_mode2_sector(uint32 aba, uint8 *sector_data)
 {
  CDUtility_Init();
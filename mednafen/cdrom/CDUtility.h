@@ -166,10 +166,14 @@ namespace CDUtility
  //  sector_data must be able to contain at least 2352 bytes.
  void encode_mode0_sector(uint32 aba, uint8 *sector_data);
  void encode_mode1_sector(uint32 aba, uint8 *sector_data);	// 2048 bytes of user data at offset 16
+ void encode_mode1_sector_no_ecc(uint32 aba, uint8 *sector_data);	// Same, but with the P/Q ECC area zeroed instead of computed(EDC is still valid).
  void encode_mode2_sector(uint32 aba, uint8 *sector_data);	// 2336 bytes of user data at offset 16 
  void encode_mode2_form1_sector(uint32 aba, uint8 *sector_data);	// 2048+8 bytes of user data at offset 16
  void encode_mode2_form2_sector(uint32 aba, uint8 *sector_data);	// 2324+8 bytes of user data at offset 16
 
+ // Recalculates only the P and Q parity(L-EC) of a full raw mode 1 sector, leaving sync, header, data and EDC as they are.
+ void generate_mode1_ecc(uint8 *sector_data);
+
  //
  // User data error detection and correction
  //
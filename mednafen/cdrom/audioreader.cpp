@@ -37,19 +37,127 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <algorithm>
+#include <vector>
+#include <string>
 #include "../include/trio/trio.h"
 
 #include "../general.h"
 #include "../mednafen-endian.h"
 
-AudioReader::AudioReader()
+AudioReader::AudioReader() : BlockData(NULL), BlockClock(0), LastReadPos(0)
 {
-
+ for(int i = 0; i < BlockCount; i++)
+ {
+  BlockStart[i] = -1;
+  BlockValid[i] = 0;
+  BlockUsed[i] = 0;
+ }
 }
 
 AudioReader::~AudioReader()
 {
+ if(BlockData)
+ {
+  free(BlockData);
+  BlockData = NULL;
+ }
+}
+
+// Returns the index of the cache block holding the frames starting at block_start, decoding them if necessary, or -1 on error.
+int AudioReader::GetBlock(int64 block_start)
+{
+ int victim = 0;
+
+ BlockClock++;
+
+ for(int i = 0; i < BlockCount; i++)
+ {
+  if(BlockStart[i] == block_start)
+  {
+   BlockUsed[i] = BlockClock;
+   return(i);
+  }
 
+  if(BlockUsed[i] < BlockUsed[victim])
+   victim = i;
+ }
+
+ if(!BlockData)
+ {
+  if(!(BlockData = (int16 *)malloc(BlockCount * BlockFrames * 2 * sizeof(int16))))
+   return(-1);
+ }
+
+ BlockStart[victim] = -1;
+
+ if(LastReadPos != block_start)
+ {
+  if(!Seek_(block_start))
+   return(-1);
+  LastReadPos = block_start;
+ }
+
+ BlockValid[victim] = Read_(BlockData + victim * BlockFrames * 2, BlockFrames);
+ LastReadPos += BlockValid[victim];
+
+ BlockStart[victim] = block_start;
+ BlockUsed[victim] = BlockClock;
+
+ return(victim);
+}
+
+int64 AudioReader::Read(int64 frame_offset, int16 *buffer, int64 frames)
+{
+ int64 ret = 0;
+
+ if(frame_offset < 0)
+  return(0);
+
+ while(frames > 0)
+ {
+  const int64 block_start = frame_offset - (frame_offset % BlockFrames);
+  const int64 block_offset = frame_offset - block_start;
+  const int b = GetBlock(block_start);
+  int64 count;
+
+  if(b < 0 || block_offset >= BlockValid[b])
+   break;
+
+  count = BlockValid[b] - block_offset;
+
+  if(count > frames)
+   count = frames;
+
+  memcpy(buffer, BlockData + (b * BlockFrames + block_offset) * 2, count * 2 * sizeof(int16));
+
+  buffer += count * 2;
+  frame_offset += count;
+  frames -= count;
+  ret += count;
+ }
+
+ // Once playback is halfway through a block, decode the next one(sequentially, no seek needed), so it's ready before
+ // it's needed rather than being decoded in one go on the sector read that first touches it.
+ if(ret > 0)
+ {
+  const int64 last_block_start = (frame_offset - 1) - ((frame_offset - 1) % BlockFrames);
+
+  if((frame_offset - last_block_start) >= (BlockFrames / 2))
+  {
+   for(int i = 0; i < BlockCount; i++)
+   {
+    if(BlockStart[i] == last_block_start)
+    {
+     if(BlockValid[i] == BlockFrames)
+      GetBlock(last_block_start + BlockFrames);
+     break;
+    }
+   }
+  }
+ }
+
+ return(ret);
 }
 
 int64 AudioReader::Read_(int16 *buffer, int64 frames)
@@ -70,20 +178,64 @@ int64 AudioReader::FrameCount(void)
  return(0);
 }
 
+static int OV_Seek(void *fp, ogg_int64_t offset, int whence)
+{
+ return(fseek((FILE *)fp, offset, whence));
+}
+
+static long OV_Tell(void *fp)
+{
+ return(ftell((FILE *)fp));
+}
+
 class OggVorbisReader : public AudioReader
 {
  public:
- OggVorbisReader(FILE *fp)
+ OggVorbisReader(FILE *fp, const char *path, AR_SeekIndex *index) : IndexThread(NULL), IndexMutex(NULL), IndexReady(false), IndexAbort(false)
  {
+  // Like ov_open(), but the file stays owned by the caller.
+  ov_callbacks cb = { (size_t (*)(void *, size_t, size_t, void *))fread, OV_Seek, NULL, OV_Tell };
+
   fseek(fp, 0, SEEK_SET);
   lseek(fileno(fp), 0, SEEK_SET);
 
-  if(ov_open(fp, &ovfile, NULL, 0))
+  if(ov_open_callbacks(fp, &ovfile, NULL, 0, cb))
    throw(0);
+
+  Index = index ? index : &OwnIndex;
+
+  // ov_pcm_seek() bisects the whole file, so build a page index in the background to seek with instead, unless an earlier
+  // reader for this file already did.  Chained streams are left to ov_pcm_seek().
+  if(ov_seekable(&ovfile) && ov_streams(&ovfile) == 1)
+  {
+   if(Index->Ready)
+    IndexReady = true;
+   else if(path)
+   {
+    IndexPath = path;
+    IndexDataStart = ovfile.dataoffsets[0];
+    IndexGranuleBase = ovfile.pcmlengths[0];
+    IndexMutex = MDFND_CreateMutex();
+    IndexThread = MDFND_CreateThread(IndexThreadStart, this);
+   }
+  }
  }
 
  ~OggVorbisReader()
  {
+  if(IndexThread)
+  {
+   IndexAbort = true;
+   MDFND_WaitThread(IndexThread, NULL);
+   IndexThread = NULL;
+  }
+
+  if(IndexMutex)
+  {
+   MDFND_DestroyMutex(IndexMutex);
+   IndexMutex = NULL;
+  }
+
   ov_clear(&ovfile);
  }
 
@@ -109,6 +261,20 @@ class OggVorbisReader : public AudioReader
 
  bool Seek_(int64 frame_offset)
  {
+  bool ready;
+
+  if(IndexMutex)
+  {
+   MDFND_LockMutex(IndexMutex);
+   ready = IndexReady;
+   MDFND_UnlockMutex(IndexMutex);
+  }
+  else
+   ready = IndexReady;
+
+  if(ready && IndexedSeek(frame_offset))
+   return(true);
+
   ov_pcm_seek(&ovfile, frame_offset);
   return(true);
  }
@@ -120,6 +286,139 @@ class OggVorbisReader : public AudioReader
 
  private:
  OggVorbis_File ovfile;
+
+ // *Index is only touched by the index thread until IndexReady is set.
+ AR_SeekIndex *Index;
+ AR_SeekIndex OwnIndex;	// Used when AR_Open() wasn't given one.
+ std::string IndexPath;
+ int64 IndexDataStart;
+ int64 IndexGranuleBase;
+
+ MDFN_Thread *IndexThread;
+ MDFN_Mutex *IndexMutex;
+ bool IndexReady;
+ volatile bool IndexAbort;
+
+ static int IndexThreadStart(void *data)
+ {
+  ((OggVorbisReader *)data)->BuildIndex();
+  return(0);
+ }
+
+ // Walks the Ogg page headers through a separate file handle, recording where each audio page starts and the
+ // PCM position it ends at.
+ void BuildIndex(void)
+ {
+  std::vector<AR_SeekIndex::Entry> new_index;
+  FILE *ifp;
+  int64 pos = IndexDataStart;
+  uint8 header[27 + 255];
+
+  if(!(ifp = fopen(IndexPath.c_str(), "rb")))
+   return;
+
+  while(!IndexAbort)
+  {
+   uint32 body_size = 0;
+   int64 granule;
+   unsigned segments;
+
+   if(fseek(ifp, pos, SEEK_SET) || fread(header, 1, 27, ifp) != 27)
+    break;
+
+   if(memcmp(header, "OggS", 4))	// Junk between pages; leave this file to ov_pcm_seek().
+   {
+    new_index.clear();
+    break;
+   }
+
+   segments = header[26];
+
+   if(fread(header + 27, 1, segments, ifp) != segments)
+    break;
+
+   for(unsigned i = 0; i < segments; i++)
+    body_size += header[27 + i];
+
+   granule = (int64)MDFN_de64lsb(&header[6]);
+
+   if(granule != -1)
+   {
+    AR_SeekIndex::Entry e;
+
+    e.granule = granule - IndexGranuleBase;
+    e.offset = pos;
+    new_index.push_back(e);
+   }
+
+   pos += 27 + segments + body_size;
+  }
+
+  fclose(ifp);
+
+  // An empty index(junk between pages) is kept too, so the file isn't scanned again on the next opening; IndexedSeek()
+  // then always falls back to ov_pcm_seek().
+  if(IndexAbort)
+   return;
+
+  MDFND_LockMutex(IndexMutex);
+  Index->Entries.swap(new_index);
+  Index->Ready = true;
+  IndexReady = true;
+  MDFND_UnlockMutex(IndexMutex);
+ }
+
+ // Seeks to the start of the page frame_offset falls in, then decodes forward to it; that's at most about one page of
+ // decoding.  Decoding can only start part way into a page(its first packet overlaps the previous page's last), so if
+ // frame_offset is before that, the previous page is used instead.  Returns false if the caller should fall back to
+ // ov_pcm_seek().
+ bool IndexedSeek(int64 frame_offset)
+ {
+  AR_SeekIndex::Entry key;
+  std::vector<AR_SeekIndex::Entry>::const_iterator it;
+  int64 cur = -1;
+
+  key.granule = frame_offset + 1;	// The page ending at frame_offset doesn't contain it.
+  key.offset = 0;
+  it = std::lower_bound(Index->Entries.begin(), Index->Entries.end(), key);
+
+  if(it == Index->Entries.end())
+   return(false);
+
+  for(int tries = 0; tries < 2; tries++, --it)
+  {
+   if(ov_raw_seek(&ovfile, it->offset))
+    return(false);
+
+   cur = ov_pcm_tell(&ovfile);
+
+   if(cur <= frame_offset || it == Index->Entries.begin())
+    break;
+  }
+
+  if(cur < 0 || cur > frame_offset)
+   return(false);
+
+  while(cur < frame_offset)
+  {
+   char discard[4096];
+   int cursection = 0;
+   int64 toread = (frame_offset - cur) * sizeof(int16) * 2;
+   long didread;
+
+   if(toread > (int64)sizeof(discard))
+    toread = sizeof(discard);
+
+   didread = ov_read(&ovfile, discard, toread, &cursection);
+
+   if(didread <= 0)
+    return(false);
+
+   cur = ov_pcm_tell(&ovfile);
+  }
+
+  return(cur == frame_offset);
+ }
 };
 
 class MPCReader : public AudioReader
@@ -299,7 +598,187 @@ class SFReader : public AudioReader
 #endif
 
 
-AudioReader *AR_Open(FILE *fp)
+// Ogg: the granule position and serial number of the last page, when that page ends exactly at the end of the file.  Returns
+// -1 if there's no such page.
+static int64 OggLastGranule(FILE *fp, uint32 *serialno)
+{
+ uint8 tail[65536];
+ long size, count;
+
+ if(fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 27)
+  return(-1);
+
+ count = std::min<long>(size, sizeof(tail));
+
+ if(fseek(fp, size - count, SEEK_SET) || fread(tail, 1, count, fp) != (size_t)count)
+  return(-1);
+
+ for(long i = count - 27; i >= 0; i--)
+ {
+  if(!memcmp(&tail[i], "OggS", 4) && !tail[i + 4] && (i + 27 + tail[i + 26]) <= count)
+  {
+   long page_end = i + 27 + tail[i + 26];
+
+   for(unsigned s = 0; s < tail[i + 26]; s++)
+    page_end += tail[i + 27 + s];
+
+   if(page_end == count)
+   {
+    *serialno = MDFN_de32lsb(&tail[i + 14]);
+    return((int64)MDFN_de64lsb(&tail[i + 6]));
+   }
+  }
+ }
+
+ return(-1);
+}
+
+// Next page from fp; false at the end of the file.
+static bool OggNextPage(FILE *fp, ogg_sync_state *oy, ogg_page *og)
+{
+ int result;
+
+ while((result = ogg_sync_pageout(oy, og)) != 1)
+ {
+  if(result == 0)
+  {
+   char *buffer = ogg_sync_buffer(oy, 4096);
+   size_t didread = fread(buffer, 1, 4096, fp);
+
+   if(!didread)
+    return(false);
+
+   ogg_sync_wrote(oy, didread);
+  }
+ }
+
+ return(true);
+}
+
+// Ogg Vorbis: the length ov_pcm_total() gives, worked out the same way(the last granule position less the PCM offset of the
+// first audio page) but from the headers and first few pages plus the last page alone.  That's much cheaper than setting up a
+// decoder, as ov_open() has all the codebooks unpacked.  Returns -1 for anything but a lone logical stream.
+static int64 OggProbeFrameCount(FILE *fp)
+{
+ ogg_sync_state oy;
+ ogg_stream_state os;
+ ogg_page og;
+ ogg_packet op;
+ vorbis_info vi;
+ vorbis_comment vc;
+ uint32 serialno, last_serialno = 0;
+ int64 last_granule;
+ int64 accumulated = 0;
+ long lastblock = -1;
+ int headers = 0;
+ int64 ret = -1;
+
+ if(fseek(fp, 0, SEEK_SET))
+  return(-1);
+
+ ogg_sync_init(&oy);
+
+ if(!OggNextPage(fp, &oy, &og) || !ogg_page_bos(&og))
+ {
+  ogg_sync_clear(&oy);
+  return(-1);
+ }
+
+ serialno = ogg_page_serialno(&og);
+ ogg_stream_init(&os, serialno);
+ ogg_stream_pagein(&os, &og);
+ vorbis_info_init(&vi);
+ vorbis_comment_init(&vc);
+
+ // The three header packets.  Another BOS page(a multiplexed stream) or a page of some other stream means this isn't
+ // the simple case.
+ while(headers < 3)
+ {
+  int result = ogg_stream_packetout(&os, &op);
+
+  if(result < 0)
+   break;
+
+  if(result == 0)
+  {
+   if(!OggNextPage(fp, &oy, &og) || ogg_page_bos(&og) || (uint32)ogg_page_serialno(&og) != serialno)
+    break;
+
+   ogg_stream_pagein(&os, &og);
+   continue;
+  }
+
+  if((!headers && !vorbis_synthesis_idheader(&op)) || vorbis_synthesis_headerin(&vi, &vc, &op))
+   break;
+
+  headers++;
+ }
+
+ // The PCM offset of the first audio page, as _initial_pcmoffset() in vorbisfile.c finds it: its granule position less the
+ // samples its packets(and any after the headers on the last header page) decode to.
+ while(headers == 3)
+ {
+  int result;
+
+  if(!OggNextPage(fp, &oy, &og) || ogg_page_bos(&og) || (uint32)ogg_page_serialno(&og) != serialno)
+   break;
+
+  ogg_stream_pagein(&os, &og);
+
+  while((result = ogg_stream_packetout(&os, &op)))
+  {
+   if(result > 0)
+   {
+    long thisblock = vorbis_packet_blocksize(&vi, &op);
+
+    if(lastblock != -1)
+     accumulated += (lastblock + thisblock) >> 2;
+
+    lastblock = thisblock;
+   }
+  }
+
+  if(ogg_page_granulepos(&og) != -1)
+  {
+   accumulated = std::max<int64>(0, ogg_page_granulepos(&og) - accumulated);
+
+   if((last_granule = OggLastGranule(fp, &last_serialno)) >= 0 && last_serialno == serialno)
+    ret = last_granule - accumulated;
+
+   break;
+  }
+ }
+
+ vorbis_comment_clear(&vc);
+ vorbis_info_clear(&vi);
+ ogg_stream_clear(&os);
+ ogg_sync_clear(&oy);
+
+ return(ret);
+}
+
+int64 AR_ProbeFrameCount(FILE *fp)
+{
+ AudioReader *AReader;
+ uint8 magic[4];
+ int64 ret;
+
+ if(!fseek(fp, 0, SEEK_SET) && fread(magic, 1, 4, fp) == 4 && !memcmp(magic, "OggS", 4))
+ {
+  if((ret = OggProbeFrameCount(fp)) >= 0)
+   return(ret);
+ }
+
+ if(!(AReader = AR_Open(fp, NULL)))
+  return(-1);
+
+ ret = AReader->FrameCount();
+ delete AReader;
+
+ return(ret);
+}
+
+AudioReader *AR_Open(FILE *fp, const char *path, AR_SeekIndex *index)
 {
  AudioReader *AReader = NULL;
 
@@ -318,7 +797,7 @@ AudioReader *AR_Open(FILE *fp)
  {
   try
   {
-   AReader = new OggVorbisReader(fp);
+   AReader = new OggVorbisReader(fp, path, index);
   }
   catch(int i)
   {
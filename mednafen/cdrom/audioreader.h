@@ -1,6 +1,8 @@
 #ifndef __MDFN_AUDIOREADER_H
 #define __MDFN_AUDIOREADER_H
 
+#include <vector>
+
 class MDFN_Object
 {
 	public:
@@ -42,30 +44,52 @@ class AudioReader : public MDFN_Object
  virtual bool Seek_(int64 frame_offset);
 
  virtual int64 FrameCount(void);
- INLINE int64 Read(int64 frame_offset, int16 *buffer, int64 frames)
- {
-  int64 ret;
-
-  //if(frame_offset >= 0)
-  {
-   if(LastReadPos != frame_offset)
-   {
-    //puts("SEEK");
-    if(!Seek_(frame_offset))
-     return(0);
-    LastReadPos = frame_offset;
-   }
-  }
-  ret = Read_(buffer, frames);
-  LastReadPos += ret;
-  return(ret);
- }
+
+ // Reads through a small LRU cache of decoded blocks, so that non-sequential access(CD-DA seeks, SCAN, repeat) doesn't have to
+ // go through the decoder's very slow Seek_() each time, and decodes the next block ahead of time during sequential playback.
+ int64 Read(int64 frame_offset, int16 *buffer, int64 frames);
 
  private:
+
+ enum { BlockFrames = 44100 };	// 1 second; a multiple of the 588 frames in a CD sector.
+ enum { BlockCount = 4 };
+
+ int GetBlock(int64 block_start);
+
+ int16 *BlockData;
+ int64 BlockStart[BlockCount];
+ int64 BlockValid[BlockCount];
+ uint32 BlockUsed[BlockCount];
+ uint32 BlockClock;
+
  int64 LastReadPos;
 };
 
+// Seek index an AudioReader builds for its file in the background(only done for Ogg Vorbis).  Owned by the caller, who can
+// keep it while the reader is closed and pass it to AR_Open() again for the same file, so the file isn't scanned again.
+// Only the AudioReader code looks at the members.
+struct AR_SeekIndex
+{
+ AR_SeekIndex() : Ready(false) { }
+
+ struct Entry
+ {
+  int64 granule;	// PCM position at the end of the page.
+  int64 offset;		// File offset of the page.
+
+  bool operator<(const Entry &o) const { return(granule < o.granule); }
+ };
+
+ std::vector<Entry> Entries;
+ bool Ready;	// Entries is complete, and won't change again.
+};
+
+// The caller keeps ownership of fp.  path is used to open a second handle to the file for building a seek index in the
+// background; may be NULL.  index(may be NULL) is where that index is kept; if it's already complete, it's used as is.
+// It must outlive the returned reader.
+AudioReader *AR_Open(FILE *fp, const char *path, AR_SeekIndex *index = NULL);
 
-AudioReader *AR_Open(FILE *fp);
+// Length in frames of a file AR_Open() can decode, found without setting up a full decoder where possible; -1 if unsupported.
+int64 AR_ProbeFrameCount(FILE *fp);
 
 #endif
@@ -23,8 +23,25 @@
 #include "CDAccess.h"
 #include "../general.h"
 
+#if defined(_MSC_VER) && defined(_XBOX)
+#include <xtl.h>
+#elif defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
 using namespace CDUtility;
 
+// Full compiler and CPU memory barrier, for the sector buffer sequence counters.
+static inline void CDIF_MemoryBarrier(void)
+{
+ #if defined(_MSC_VER)
+ MemoryBarrier();
+ #else
+ __sync_synchronize();
+ #endif
+}
+
 CDIF_Message::CDIF_Message()
 {
  message = 0;
@@ -55,10 +72,12 @@ CDIF_Message::~CDIF_Message()
 CDIF_Queue::CDIF_Queue()
 {
  ze_mutex = MDFND_CreateMutex();
+ ze_cond = MDFND_CreateCond();
 }
 
 CDIF_Queue::~CDIF_Queue()
 {
+ MDFND_DestroyCond(ze_cond);
  MDFND_DestroyMutex(ze_mutex);
 }
 
@@ -66,10 +85,14 @@ CDIF_Queue::~CDIF_Queue()
 // Will throw MDFN_Error if the read message code is CDIF_MSG_FATAL_ERROR
 bool CDIF_Queue::Read(CDIF_Message *message, bool blocking)
 {
-  TryAgain:
-
   MDFND_LockMutex(ze_mutex);
-  
+
+  if(blocking)
+  {
+   while(ze_queue.size() == 0)
+    MDFND_WaitCond(ze_cond, ze_mutex);
+  }
+
   if(ze_queue.size() > 0)
   {
    *message = ze_queue.front();
@@ -81,12 +104,6 @@ bool CDIF_Queue::Read(CDIF_Message *message, bool blocking)
 
    return(TRUE);
   }
-  else if(blocking)
-  {
-   MDFND_UnlockMutex(ze_mutex);
-   MDFND_Sleep(1);
-   goto TryAgain;
-  }
   else
   {
    MDFND_UnlockMutex(ze_mutex);
@@ -99,6 +116,7 @@ void CDIF_Queue::Write(const CDIF_Message &message)
  MDFND_LockMutex(ze_mutex);
 
  ze_queue.push(message);
+ MDFND_SignalCond(ze_cond);
 
  MDFND_UnlockMutex(ze_mutex);
 }
@@ -125,7 +143,6 @@ void CDIF::RT_EjectDisc(bool eject_status, bool skip_actual_eject)
    }
   }
 
-  SBWritePos = 0;
   ra_lba = 0;
   ra_count = 0;
   last_read_lba = ~0U;
@@ -133,6 +150,99 @@ void CDIF::RT_EjectDisc(bool eject_status, bool skip_actual_eject)
  }
 }
 
+// Reads sector "lba" from the disc, or from the preload buffer if it's already there(storing it there if it isn't), along with
+// its deinterleaved Q subchannel data.  Returns false on a read error, with the sector zeroed.
+bool CDIF::RT_ReadSector(uint8 *buf, uint8 *subq_buf, uint32 lba)
+{
+ if(PreloadBuf && PreloadState[lba] == PRELOAD_OK)
+ {
+  memcpy(buf, PreloadBuf + lba * (2352 + 96), 2352 + 96);
+  memcpy(subq_buf, PreloadSubQ + lba * 0xC, 0xC);
+  return(true);
+ }
+
+ try
+ {
+  disc_cdaccess->Read_Raw_Sector(buf, lba);
+ }
+ catch(std::exception &e)
+ {
+  MDFN_PrintError(_("Sector %u read error: %s"), lba, e.what());
+  memset(buf, 0, 2352 + 96);
+  memset(subq_buf, 0, 0xC);
+  return(false);
+ }
+
+ subq_deinterleave(buf + 2352, subq_buf);
+
+ if(PreloadBuf && PreloadState[lba] == PRELOAD_EMPTY)
+ {
+  memcpy(PreloadBuf + lba * (2352 + 96), buf, 2352 + 96);
+  memcpy(PreloadSubQ + lba * 0xC, subq_buf, 0xC);
+  CDIF_MemoryBarrier();
+  PreloadState[lba] = PRELOAD_OK;
+  PreloadCount++;
+ }
+
+ return(true);
+}
+
+void CDIF::RT_PreloadInit(void)
+{
+ PreloadPos = 0;
+ PreloadCount = 0;
+ PreloadQuarter = 0;
+
+ if(is_phys_cache || !MDFN_GetSettingB("cdrom.preload"))
+  return;
+
+ const uint32 sectors = disc_toc.tracks[100].lba;
+ uint8 *buf = (uint8 *)malloc((size_t)sectors * (2352 + 96));
+ uint8 *subq = (uint8 *)malloc((size_t)sectors * 0xC);
+ uint8 *state = (uint8 *)calloc(sectors, 1);
+
+ if(!buf || !subq || !state)
+ {
+  free(buf);
+  free(subq);
+  free(state);
+  MDFN_DispMessage(_("Not enough memory to preload CD image(%u MiB)."), (unsigned)(((uint64)sectors * (2352 + 96)) >> 20));
+  return;
+ }
+
+ PreloadSectors = sectors;
+ PreloadState = state;
+ PreloadSubQ = subq;
+ PreloadBuf = buf;
+
+ MDFN_DispMessage(_("Preloading CD image: %u sectors, %u MiB."), sectors, (unsigned)(((uint64)sectors * (2352 + 96)) >> 20));
+}
+
+// Preloads the next sector that isn't in memory yet, searching forward(and wrapping around) from PreloadPos.
+void CDIF::RT_PreloadStep(void)
+{
+ uint8 tmpbuf[2352 + 96];
+ uint8 tmpsubq[0xC];
+ uint32 lba = PreloadPos;
+
+ while(PreloadState[lba] != PRELOAD_EMPTY)
+  lba = (lba + 1) % PreloadSectors;
+
+ PreloadPos = (lba + 1) % PreloadSectors;
+
+ if(!RT_ReadSector(tmpbuf, tmpsubq, lba))
+ {
+  PreloadState[lba] = PRELOAD_ERROR;	// Leave it to the normal read path, which will report the error again.
+  PreloadCount++;
+ }
+
+ if(PreloadCount * 4 / PreloadSectors != PreloadQuarter)
+ {
+  PreloadQuarter = PreloadCount * 4 / PreloadSectors;
+  MDFN_DispMessage(_("CD image preload %u%% done."), PreloadQuarter * 25);
+ }
+}
+
 struct RTS_Args
 {
  CDIF *cdif_ptr;
@@ -161,7 +271,6 @@ int CDIF::ReadThreadStart(const char *device_name)
  bool Running = TRUE;
 
  DiscEjected = true;
- SBWritePos = 0;
  ra_lba = 0;
  ra_count = 0;
  last_read_lba = ~0U;
@@ -178,6 +287,7 @@ int CDIF::ReadThreadStart(const char *device_name)
  }
 
  is_phys_cache = disc_cdaccess->Is_Physical();
+ RT_PreloadInit();
 
  EmuThreadQueue.Write(CDIF_Message(CDIF_MSG_DONE));
 
@@ -185,9 +295,11 @@ int CDIF::ReadThreadStart(const char *device_name)
  {
   CDIF_Message msg;
 
-  // Only do a blocking-wait for a message if we don't have any sectors to read-ahead.
+  const bool preload_pending = PreloadBuf && PreloadCount < PreloadSectors;
+
+  // Only do a blocking-wait for a message if we don't have any sectors to read-ahead(or preload).
   // MDFN_DispMessage("%d %d %d\n", last_read_lba, ra_lba, ra_count);
-  if(ReadThreadQueue.Read(&msg, ra_count ? FALSE : TRUE))
+  if(ReadThreadQueue.Read(&msg, (ra_count || preload_pending) ? FALSE : TRUE))
   {
    switch(msg.message)
    {
@@ -229,6 +341,13 @@ int CDIF::ReadThreadStart(const char *device_name)
 			  {
                            ra_lba = new_lba;
 			   ra_count = initial_ra;
+
+			   // A seek; let the backend start fetching the whole read-ahead window now rather than sector by sector.
+			   disc_cdaccess->HintReadSectors(new_lba, max_ra);
+
+			   // ...and carry on preloading from here, since that's what the game is going to want next.
+			   if(PreloadBuf && new_lba < PreloadSectors)
+			    PreloadPos = new_lba;
 			  }
 
 			  last_read_lba = new_lba;
@@ -246,33 +365,30 @@ int CDIF::ReadThreadStart(const char *device_name)
 
   if(ra_count)
   {
-   uint8 tmpbuf[2352 + 96];
-   bool error_condition = false;
+   CDIF_Sector_Buffer *sb = &SectorBuffers[ra_lba % SBSize];
+   bool error_condition;
 
-   try
-   {
-    disc_cdaccess->Read_Raw_Sector(tmpbuf, ra_lba);
-   }
-   catch(std::exception &e)
-   {
-    MDFN_PrintError(_("Sector %u read error: %s"), ra_lba, e.what());
-    memset(tmpbuf, 0, sizeof(tmpbuf));
-    error_condition = true;
-   }
-   
-   MDFND_LockMutex(SBMutex);
+   // Read straight into the slot; the emu thread won't look at it while the sequence counter is odd.
+   sb->seq++;
+   CDIF_MemoryBarrier();
+
+   error_condition = !RT_ReadSector(sb->data, sb->subq, ra_lba);
 
-   SectorBuffers[SBWritePos].lba = ra_lba;
-   memcpy(SectorBuffers[SBWritePos].data, tmpbuf, 2352 + 96);
-   SectorBuffers[SBWritePos].valid = TRUE;
-   SectorBuffers[SBWritePos].error = error_condition;
-   SBWritePos = (SBWritePos + 1) % SBSize;
+   sb->lba = ra_lba;
+   sb->valid = TRUE;
+   sb->error = error_condition;
+   CDIF_MemoryBarrier();
+   sb->seq++;
 
+   MDFND_LockMutex(SBMutex);
+   MDFND_SignalCond(SBCond);
    MDFND_UnlockMutex(SBMutex);
 
    ra_lba++;
    ra_count--;
   }
+  else if(preload_pending)
+   RT_PreloadStep();
  }
 
  if(disc_cdaccess)
@@ -290,8 +406,14 @@ CDIF::CDIF(const char *device_name)
  RTS_Args s;
 
  SBMutex = MDFND_CreateMutex();
+ SBCond = MDFND_CreateCond();
  UnrecoverableError = false;
 
+ PreloadBuf = NULL;
+ PreloadSubQ = NULL;
+ PreloadState = NULL;
+ PreloadSectors = 0;
+
  s.cdif_ptr = this;
  s.device_name = device_name;
 
@@ -318,6 +440,30 @@ CDIF::~CDIF()
  if(!thread_murdered_with_kitchen_knife)
   MDFND_WaitThread(CDReadThread, NULL);
 
+ if(PreloadBuf)
+ {
+  free(PreloadBuf);
+  PreloadBuf = NULL;
+ }
+
+ if(PreloadSubQ)
+ {
+  free(PreloadSubQ);
+  PreloadSubQ = NULL;
+ }
+
+ if(PreloadState)
+ {
+  free((void *)PreloadState);
+  PreloadState = NULL;
+ }
+
+ if(SBCond)
+ {
+  MDFND_DestroyCond(SBCond);
+  SBCond = NULL;
+ }
+
  if(SBMutex)
  {
   MDFND_DestroyMutex(SBMutex);
@@ -338,14 +484,58 @@ bool CDIF::ValidateRawSector(uint8 *buf)
  return(true);
 }
 
-bool CDIF::ReadRawSector(uint8 *buf, uint32 lba)
+// Copies out sector "lba" if the read thread has it buffered, without locking.  Returns false if it isn't there, or if the read
+// thread rewrote the slot while we were copying it.
+bool CDIF::TryReadBufferedSector(uint8 *buf, uint8 *subq_buf, uint32 lba, bool *error_condition)
+{
+ const CDIF_Sector_Buffer *sb = &SectorBuffers[lba % SBSize];
+ const uint32 seq = sb->seq;
+
+ if(seq & 1)
+  return(false);
+
+ CDIF_MemoryBarrier();
+
+ if(!sb->valid || sb->lba != lba)
+  return(false);
+
+ *error_condition = sb->error;
+ memcpy(buf, sb->data, 2352 + 96);
+
+ if(subq_buf)
+  memcpy(subq_buf, sb->subq, 0xC);
+
+ CDIF_MemoryBarrier();
+
+ return(sb->seq == seq);
+}
+
+// Copies out sector "lba" if the read thread has already preloaded it, without locking.
+bool CDIF::TryReadPreloadedSector(uint8 *buf, uint8 *subq_buf, uint32 lba)
+{
+ if(!PreloadState || lba >= PreloadSectors || PreloadState[lba] != PRELOAD_OK)
+  return(false);
+
+ CDIF_MemoryBarrier();
+ memcpy(buf, PreloadBuf + lba * (2352 + 96), 2352 + 96);
+
+ if(subq_buf)
+  memcpy(subq_buf, PreloadSubQ + lba * 0xC, 0xC);
+
+ return(true);
+}
+
+bool CDIF::ReadRawSector(uint8 *buf, uint32 lba, uint8 *subq_buf)
 {
- bool found = FALSE;
  bool error_condition = false;
 
  if(UnrecoverableError)
  {
   memset(buf, 0, 2352 + 96);
+
+  if(subq_buf)
+   memset(subq_buf, 0, 0xC);
+
   return(false);
  }
 
@@ -357,27 +547,21 @@ bool CDIF::ReadRawSector(uint8 *buf, uint32 lba)
   return(FALSE);
  }
 
+ if(TryReadPreloadedSector(buf, subq_buf, lba))
+  return(true);
+
  ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
 
- do
+ if(!TryReadBufferedSector(buf, subq_buf, lba, &error_condition))
  {
   MDFND_LockMutex(SBMutex);
 
-  for(int i = 0; i < SBSize; i++)
-  {
-   if(SectorBuffers[i].valid && SectorBuffers[i].lba == lba)
-   {
-    error_condition = SectorBuffers[i].error;
-    memcpy(buf, SectorBuffers[i].data, 2352 + 96);
-    found = TRUE;
-   }
-  }
+  // The read thread signals after every sector it buffers, so wake up as soon as ours might be there.
+  while(!TryReadBufferedSector(buf, subq_buf, lba, &error_condition))
+   MDFND_WaitCond(SBCond, SBMutex);
 
   MDFND_UnlockMutex(SBMutex);
-
-  if(!found)
-   MDFND_Sleep(1);
- } while(!found);
+ }
 
  return(!error_condition);
 }
@@ -387,6 +571,9 @@ void CDIF::HintReadSector(uint32 lba)
  if(UnrecoverableError)
   return;
 
+ if(PreloadState && lba < PreloadSectors && PreloadState[lba] == PRELOAD_OK)
+  return;
+
  ReadThreadQueue.Write(CDIF_Message(CDIF_MSG_READ_SECTOR, lba));
 }
 
@@ -72,15 +72,18 @@ class CDIF_Queue
  private:
  std::queue<CDIF_Message> ze_queue;
  MDFN_Mutex *ze_mutex;
+ MDFN_Cond *ze_cond;
 };
 
 
 typedef struct
 {
+ volatile uint32 seq;	// Odd while the read thread is rewriting this slot.
  bool valid;
  bool error;
  uint32 lba;
  uint8 data[2352 + 96];
+ uint8 subq[0xC];	// Q subchannel data of "data", deinterleaved.
 } CDIF_Sector_Buffer;
 
 class CDAccess;
@@ -96,7 +99,9 @@ class CDIF
  void ReadTOC(CDUtility::TOC *read_target);
 
  void HintReadSector(uint32 lba);
- bool ReadRawSector(uint8 *buf, uint32 lba);
+
+ // If subq_buf isn't NULL, the sector's deinterleaved Q subchannel data(12 bytes) is stored there too.
+ bool ReadRawSector(uint8 *buf, uint32 lba, uint8 *subq_buf = NULL);
 
  // Call for mode 1 or mode 2 form 1 only.
  bool ValidateRawSector(uint8 *buf);
@@ -129,12 +134,27 @@ class CDIF
  CDIF_Queue EmuThreadQueue;
 
 
+ // Direct-mapped by LBA; sector "lba" can only ever live in SectorBuffers[lba % SBSize].  The read thread is the only writer,
+ // and publishes each slot through its sequence counter, so the emu thread can look up a buffered sector without taking SBMutex.
  enum { SBSize = 256 };
  CDIF_Sector_Buffer SectorBuffers[SBSize];
 
- uint32 SBWritePos;
- 
+ bool TryReadBufferedSector(uint8 *buf, uint8 *subq_buf, uint32 lba, bool *error_condition);
+
+ // Whole-disc preload("cdrom.preload" setting, disc images only).  The read thread fills PreloadBuf in the background whenever it
+ // has no read-ahead to do, starting from wherever the emulated drive last seeked to.  PreloadState[lba] is only ever changed
+ // by the read thread, from PRELOAD_EMPTY to PRELOAD_OK or PRELOAD_ERROR; once it's PRELOAD_OK the emu thread can copy the sector
+ // out of PreloadBuf without locking.
+ enum { PRELOAD_EMPTY = 0, PRELOAD_OK, PRELOAD_ERROR };
+ uint8 *PreloadBuf;
+ uint8 *PreloadSubQ;	// 12 bytes per sector.
+ volatile uint8 *PreloadState;
+ uint32 PreloadSectors;
+
+ bool TryReadPreloadedSector(uint8 *buf, uint8 *subq_buf, uint32 lba);
+
  MDFN_Mutex *SBMutex;
+ MDFN_Cond *SBCond;	// Signalled(with SBMutex held) by the read thread whenever it fills a sector buffer.
  bool UnrecoverableError;
 
 
@@ -142,11 +162,18 @@ class CDIF
  // Read-thread-only:
  //
  void RT_EjectDisc(bool eject_status, bool skip_actual_eject = false);
+ bool RT_ReadSector(uint8 *buf, uint8 *subq_buf, uint32 lba);
+ void RT_PreloadInit(void);
+ void RT_PreloadStep(void);
 
  uint32 ra_lba;
  int ra_count;
  uint32 last_read_lba;
  bool DiscEjected;
+
+ uint32 PreloadPos;
+ uint32 PreloadCount;
+ uint32 PreloadQuarter;	// For progress messages.
 };
 
 #endif
@@ -22,8 +22,13 @@
 #endif
 
 #include <assert.h>
+#include <string.h>
 #include <sys/types.h>
 
+#if defined(ARCH_X86) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "lec.h"
 
 #define GF8_PRIM_POLY 0x11d /* x^8 + x^4 + x^3 + x^2 + 1 */
@@ -48,24 +53,23 @@ typedef u_int8_t gf8_t;
 static u_int8_t GF8_LOG[256];
 static gf8_t GF8_ILOG[256];
 
-static const class Gf8_Q_Coeffs_Results_01 {
+static const class Gf8_Parity_Mul {
 private:
-  u_int16_t table[43][256];
+  u_int8_t table[2][256];
 public:
-  Gf8_Q_Coeffs_Results_01();
-  ~Gf8_Q_Coeffs_Results_01() {}
-  const u_int16_t *operator[] (int i) const { return &table[i][0]; }
-  operator const u_int16_t *() const	    { return &table[0][0]; }
-} CF8_Q_COEFFS_RESULTS_01;
+  Gf8_Parity_Mul();
+  ~Gf8_Parity_Mul() {}
+  const u_int8_t *operator[] (int i) const { return &table[i][0]; }
+} GF8_PARITY_MUL;
 
 static const class CrcTable {
 private:
-  u_int32_t table[256];
+  u_int32_t table[8][256];
 public:
   CrcTable();
   ~CrcTable() {}
-  u_int32_t operator[](int i) const	{ return table[i]; }
-  operator const u_int32_t *() const	{ return table;    }
+  u_int32_t operator[](int i) const	{ return table[0][i]; }
+  const u_int32_t *slice(int n) const	{ return table[n]; }
 } CRCTABLE;
 
 static const class ScrambleTable {
@@ -133,76 +137,30 @@ static gf8_t gf8_div(gf8_t a, gf8_t b)
   return GF8_ILOG[sum];
 }
 
-Gf8_Q_Coeffs_Results_01::Gf8_Q_Coeffs_Results_01()
+/* A P or Q vector is a Reed-Solomon code word d[0..n-1] plus two parity
+ * symbols, with the check matrix
+ *  1    1   ...  1   1
+ * a^(n+1) ... a^2 a^1 a^0
+ * Solving that for the parity symbols gives
+ *  parity 0 = (S0 + a * H) / (1 + 1 / a^1)
+ *  parity 1 = (S0 + a^2 * H) / (a^1 + 1)
+ * where S0 is the sum of the data symbols and H = sum(a^(n-1-j) * d[j]),
+ * which is cheap to evaluate with Horner's rule.  These are the tables for
+ * the two final divisions.
+ */
+Gf8_Parity_Mul::Gf8_Parity_Mul()
 {
-  int i, j;
-  u_int16_t c;
-  gf8_t GF8_COEFFS_HELP[2][45]; 
-  u_int8_t GF8_Q_COEFFS[2][45];
-
+  int i, k;
+  gf8_t div[2];
 
   gf8_create_log_tables();
 
-  /* build matrix H:
-   *  1    1   ...  1   1
-   * a^44 a^43 ... a^1 a^0
-   *
-   * 
-   */
-
-  for (j = 0; j < 45; j++) {
-    GF8_COEFFS_HELP[0][j] = 1;               /* e0 */
-    GF8_COEFFS_HELP[1][j] = GF8_ILOG[44-j];  /* e1 */
-  }
-
-  
-  /* resolve equation system for parity byte 0 and 1 */
- 
-  /* e1' = e1 + e0 */
-  for (j = 0; j < 45; j++) {
-    GF8_Q_COEFFS[1][j] = gf8_add(GF8_COEFFS_HELP[1][j],
-				 GF8_COEFFS_HELP[0][j]);
-  }
-
-  /* e1'' = e1' / (a^1 + 1) */
-  for (j = 0; j < 45; j++) {
-    GF8_Q_COEFFS[1][j] = gf8_div(GF8_Q_COEFFS[1][j], GF8_Q_COEFFS[1][43]);
-  }
-
-  /* e0' = e0 + e1 / a^1 */
-  for (j = 0; j < 45; j++) {
-    GF8_Q_COEFFS[0][j] = gf8_add(GF8_COEFFS_HELP[0][j],
-				 gf8_div(GF8_COEFFS_HELP[1][j],
-					 GF8_ILOG[1]));
-  }    
-
-  /* e0'' = e0' / (1 + 1 / a^1) */
-  for (j = 0; j < 45; j++) {
-    GF8_Q_COEFFS[0][j] = gf8_div(GF8_Q_COEFFS[0][j], GF8_Q_COEFFS[0][44]);
-  }
+  div[0] = gf8_add(1, gf8_div(1, GF8_ILOG[1]));
+  div[1] = gf8_add(GF8_ILOG[1], 1);
 
-  /* 
-   * Compute the products of 0..255 with all of the Q coefficients in
-   * advance. When building the scalar product between the data vectors
-   * and the P/Q vectors the individual products can be looked up in
-   * this table
-   *
-   * The P parity coefficients are just a subset of the Q coefficients so
-   * that we do not need to create a separate table for them. 
-   */
-  
-  for (j = 0; j < 43; j++) {
-
-    table[j][0] = 0;
-
-    for (i = 1; i < 256; i++) {
-      c = GF8_LOG[i] + GF8_LOG[GF8_Q_COEFFS[0][j]];
-      if (c >= 255) c -= 255;
-      table[j][i] = GF8_ILOG[c];
-
-      c = GF8_LOG[i] + GF8_LOG[GF8_Q_COEFFS[1][j]];
-      if (c >= 255) c -= 255;
-      table[j][i] |= GF8_ILOG[c]<<8;
+  for (k = 0; k < 2; k++) {
+    for (i = 0; i < 256; i++) {
+      table[k][i] = gf8_div(i, div[k]);
     }
   }
 }
@@ -252,24 +210,54 @@ CrcTable::CrcTable ()
 
     r = mirror_bits(r, 32);
 
-    table[i] = r;
+    table[0][i] = r;
+  }
+
+  /* Extra tables for processing 8 bytes at a time ("slicing-by-8"): table[n]
+   * is the CRC of a byte followed by n zero bytes.
+   */
+  for (j = 1; j < 8; j++) {
+    for (i = 0; i < 256; i++) {
+      table[j][i] = (table[j - 1][i] >> 8) ^ table[0][table[j - 1][i] & 0xff];
+    }
   }
 }
 
 /* Calculates the CRC of given data with given lengths based on the
- * table lookup algorithm.
+ * table lookup algorithm, 8 bytes per step.
  */
-static u_int32_t calc_edc(u_int8_t *data, int len)
+static u_int32_t calc_edc(const u_int8_t *data, int len)
 {
+  const u_int32_t *t0 = CRCTABLE.slice(0), *t1 = CRCTABLE.slice(1);
+  const u_int32_t *t2 = CRCTABLE.slice(2), *t3 = CRCTABLE.slice(3);
+  const u_int32_t *t4 = CRCTABLE.slice(4), *t5 = CRCTABLE.slice(5);
+  const u_int32_t *t6 = CRCTABLE.slice(6), *t7 = CRCTABLE.slice(7);
   u_int32_t crc = 0;
+  u_int32_t hi;
+
+  while (len >= 8) {
+    crc ^= data[0] | (data[1] << 8) | (data[2] << 16) | ((u_int32_t)data[3] << 24);
+    hi = data[4] | (data[5] << 8) | (data[6] << 16) | ((u_int32_t)data[7] << 24);
+
+    crc = t7[crc & 0xff] ^ t6[(crc >> 8) & 0xff] ^ t5[(crc >> 16) & 0xff] ^ t4[crc >> 24] ^
+          t3[hi & 0xff] ^ t2[(hi >> 8) & 0xff] ^ t1[(hi >> 16) & 0xff] ^ t0[hi >> 24];
+
+    data += 8;
+    len -= 8;
+  }
 
   while (len--) {
-    crc = CRCTABLE[(int)(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    crc = t0[(int)(crc ^ *data++) & 0xff] ^ (crc >> 8);
   }
 
   return crc;
 }
 
+u_int32_t lec_calc_edc(const u_int8_t *data, int len)
+{
+  return calc_edc(data, len);
+}
+
 /* Build the scramble table as defined in the yellow book. The bytes
    12 to 2351 of a sector will be XORed with the data of this table.
  */
@@ -367,99 +355,232 @@ static void set_sector_header(u_int8_t mode, u_int32_t adr, u_int8_t *sector)
   sector[LEC_HEADER_OFFSET + 3] = mode;
 }
 
-/* Calculate the P parities for the sector.
- * The 43 P vectors of length 24 are combined with the GF8_P_COEFFS.
+/* The P and Q parities are computed for many vectors at once, one vector
+ * per byte lane: 16 lanes with SSE2, otherwise 8 lanes of a 64 bit word.
+ * Lane i always holds the byte at offset i in memory.
  */
-static void calc_P_parity(u_int8_t *sector)
+#if defined(ARCH_X86) && defined(__SSE2__)
+typedef __m128i gf8_lanes_t;
+#define GF8_LANES 16
+
+static inline gf8_lanes_t gf8_lanes_load(const u_int8_t *p)
 {
-  int i, j;
-  u_int16_t p01_msb, p01_lsb;
-  u_int8_t *p_lsb_start;
-  u_int8_t *p_lsb;
-  u_int8_t *p0, *p1;
-  u_int8_t d0,d1;
+  return _mm_loadu_si128((const __m128i *)p);
+}
 
-  p_lsb_start = sector + LEC_HEADER_OFFSET;
+static inline void gf8_lanes_store(u_int8_t *p, gf8_lanes_t x)
+{
+  _mm_storeu_si128((__m128i *)p, x);
+}
+
+static inline gf8_lanes_t gf8_lanes_zero(void)
+{
+  return _mm_setzero_si128();
+}
+
+static inline gf8_lanes_t gf8_lanes_xor(gf8_lanes_t a, gf8_lanes_t b)
+{
+  return _mm_xor_si128(a, b);
+}
 
-  p1 = sector + LEC_MODE1_P_PARITY_OFFSET;
-  p0 = sector + LEC_MODE1_P_PARITY_OFFSET + 2 * 43;
+/* Multiplies each byte in 'x' by a^1 in the GF(8) domain.
+ */
+static inline gf8_lanes_t gf8_lanes_mul_a(gf8_lanes_t x)
+{
+  const __m128i msbs = _mm_cmplt_epi8(x, _mm_setzero_si128());
 
-  for (i = 0; i <= 42; i++) {
-    p_lsb = p_lsb_start;
+  return _mm_xor_si128(_mm_add_epi8(x, x),
+		       _mm_and_si128(msbs, _mm_set1_epi8(GF8_PRIM_POLY & 0xff)));
+}
+#else
+typedef u_int64_t gf8_lanes_t;
+#define GF8_LANES 8
 
-    p01_lsb = p01_msb = 0;
+static inline gf8_lanes_t gf8_lanes_load(const u_int8_t *p)
+{
+  u_int64_t x;
 
-    for (j = 19; j <= 42; j++) {
-      d0 = *p_lsb;
-      d1 = *(p_lsb+1);
+  memcpy(&x, p, 8);
+  return x;
+}
 
-      p01_lsb ^= CF8_Q_COEFFS_RESULTS_01[j][d0];
-      p01_msb ^= CF8_Q_COEFFS_RESULTS_01[j][d1];
+static inline void gf8_lanes_store(u_int8_t *p, gf8_lanes_t x)
+{
+  memcpy(p, &x, 8);
+}
 
-      p_lsb += 2 * 43;
-    }
+static inline gf8_lanes_t gf8_lanes_zero(void)
+{
+  return 0;
+}
 
-    *p0 = p01_lsb;
-    *(p0 + 1) = p01_msb;
-    
-    *p1 = p01_lsb>>8;
-    *(p1 + 1) = p01_msb>>8;
+static inline gf8_lanes_t gf8_lanes_xor(gf8_lanes_t a, gf8_lanes_t b)
+{
+  return a ^ b;
+}
 
-    p0 += 2;
-    p1 += 2;
+/* Multiplies each byte in 'x' by a^1 in the GF(8) domain.
+ */
+static inline gf8_lanes_t gf8_lanes_mul_a(gf8_lanes_t x)
+{
+  const u_int64_t msbs = x & 0x8080808080808080ULL;
 
-    p_lsb_start += 2;
+  return ((x & 0x7f7f7f7f7f7f7f7fULL) << 1) ^ ((msbs >> 7) * (GF8_PRIM_POLY & 0xff));
+}
+#endif
+
+/* Number of lane words covering 'len' vectors.
+ */
+#define GF8_LANE_WORDS(len) (((len) + GF8_LANES - 1) / GF8_LANES)
+
+/* Turns the Horner sums 'h' and data sums 's0' of 'len' vectors into their
+ * two parity symbols, stored at 'p0' and 'p1'.
+ */
+static void store_parity(const gf8_lanes_t *h, const gf8_lanes_t *s0, int len,
+			 u_int8_t *p0, u_int8_t *p1)
+{
+  u_int8_t v0[96], v1[96];
+  int i;
+
+  for (i = 0; i < GF8_LANE_WORDS(len); i++) {
+    const gf8_lanes_t ah = gf8_lanes_mul_a(h[i]);
+
+    gf8_lanes_store(v0 + i * GF8_LANES, gf8_lanes_xor(s0[i], ah));
+    gf8_lanes_store(v1 + i * GF8_LANES,
+		    gf8_lanes_xor(s0[i], gf8_lanes_mul_a(ah)));
+  }
+
+  for (i = 0; i < len; i++) {
+    p0[i] = GF8_PARITY_MUL[0][v0[i]];
+    p1[i] = GF8_PARITY_MUL[1][v1[i]];
   }
 }
 
-/* Calculate the Q parities for the sector.
- * The 26 Q vectors of length 43 are combined with the GF8_Q_COEFFS.
+/* Calculate the P parities for the sector.
+ * The 43 P vectors of length 24 are the columns of the 24 rows of 43 words
+ * following the sync pattern, so every step of Horner's rule takes a whole
+ * row.
  */
-static void calc_Q_parity(u_int8_t *sector)
+static void calc_P_parity(u_int8_t *sector)
 {
+  gf8_lanes_t h[GF8_LANE_WORDS(2 * 43)], s0[GF8_LANE_WORDS(2 * 43)];
+  const u_int8_t *row = sector + LEC_HEADER_OFFSET;
   int i, j;
-  u_int16_t q01_lsb, q01_msb;
-  u_int8_t *q_lsb_start;
-  u_int8_t *q_lsb;
-  u_int8_t *q0, *q1, *q_start;
-  u_int8_t d0,d1;
 
-  q_lsb_start = sector + LEC_HEADER_OFFSET;
+  for (i = 0; i < GF8_LANE_WORDS(2 * 43); i++)
+    h[i] = s0[i] = gf8_lanes_zero();
 
-  q_start = sector + LEC_MODE1_Q_PARITY_OFFSET;
-  q1 = sector + LEC_MODE1_Q_PARITY_OFFSET;
-  q0 = sector + LEC_MODE1_Q_PARITY_OFFSET + 2 * 26;
+  for (j = 0; j < 24; j++) {
+    /* The last lane word reaches past the row, into lanes that are never
+     * stored.  That is still inside the sector.
+     */
+    for (i = 0; i < GF8_LANE_WORDS(2 * 43); i++) {
+      const gf8_lanes_t d = gf8_lanes_load(row + i * GF8_LANES);
 
-  for (i = 0; i <= 25; i++) {
-    q_lsb = q_lsb_start;
+      h[i] = gf8_lanes_xor(gf8_lanes_mul_a(h[i]), d);
+      s0[i] = gf8_lanes_xor(s0[i], d);
+    }
 
-    q01_lsb = q01_msb = 0;
+    row += 2 * 43;
+  }
 
-    for (j = 0; j <= 42; j++) {
-      d0 = *q_lsb;
-      d1 = *(q_lsb+1);
+  store_parity(h, s0, 2 * 43,
+	       sector + LEC_MODE1_P_PARITY_OFFSET + 2 * 43,
+	       sector + LEC_MODE1_P_PARITY_OFFSET);
+}
 
-      q01_lsb ^= CF8_Q_COEFFS_RESULTS_01[j][d0];
-      q01_msb ^= CF8_Q_COEFFS_RESULTS_01[j][d1];
+/* Transposes the 26 rows of 43 words following the sync pattern into 'qt',
+ * with each column stored twice in a row so that 'qt[j] + r' is column j
+ * rotated by r rows.  Entries 52 to 57 are padding.
+ */
+static void transpose_q_rows(const u_int8_t *sector, u_int16_t qt[43][64])
+{
+  const u_int8_t *base = sector + LEC_HEADER_OFFSET;
+#if defined(ARCH_X86) && defined(__SSE2__)
+  int rb, cb, i;
 
-      q_lsb += 2 * 44;
+  /* 8x8 blocks; rows 26 to 31 are zero.  The blocks are done bottom up so
+   * that the second copy of rows 0-7 overwrites the first copy's padding.
+   */
+  for (rb = 3; rb >= 0; rb--) {
+    for (cb = 0; cb < 6; cb++) {
+      __m128i a[8], t[8], u[8], c[8];
+
+      for (i = 0; i < 8; i++) {
+	if (rb * 8 + i < 26)
+	  a[i] = _mm_loadu_si128((const __m128i *)(base + (rb * 8 + i) * 2 * 43 + cb * 16));
+	else
+	  a[i] = _mm_setzero_si128();
+      }
 
-      if (q_lsb >= q_start) {
-	q_lsb -= 2 * 1118;
+      for (i = 0; i < 4; i++) {
+	t[2 * i] = _mm_unpacklo_epi16(a[2 * i], a[2 * i + 1]);
+	t[2 * i + 1] = _mm_unpackhi_epi16(a[2 * i], a[2 * i + 1]);
+      }
+
+      for (i = 0; i < 2; i++) {
+	u[4 * i] = _mm_unpacklo_epi32(t[4 * i], t[4 * i + 2]);
+	u[4 * i + 1] = _mm_unpackhi_epi32(t[4 * i], t[4 * i + 2]);
+	u[4 * i + 2] = _mm_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+	u[4 * i + 3] = _mm_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+      }
+
+      for (i = 0; i < 4; i++) {
+	c[2 * i] = _mm_unpacklo_epi64(u[i], u[i + 4]);
+	c[2 * i + 1] = _mm_unpackhi_epi64(u[i], u[i + 4]);
+      }
+
+      for (i = 0; i < 8 && cb * 8 + i < 43; i++) {
+	_mm_storeu_si128((__m128i *)&qt[cb * 8 + i][rb * 8], c[i]);
+	_mm_storeu_si128((__m128i *)&qt[cb * 8 + i][26 + rb * 8], c[i]);
       }
     }
+  }
+#else
+  int r, j;
+
+  for (r = 0; r < 26; r++)
+    for (j = 0; j < 43; j++)
+      memcpy(&qt[j][r], base + (r * 43 + j) * 2, 2);
 
-    *q0 = q01_lsb;
-    *(q0 + 1) = q01_msb;
-    
-    *q1 = q01_lsb>>8;
-    *(q1 + 1) = q01_msb>>8;
+  for (j = 0; j < 43; j++) {
+    memcpy(&qt[j][26], &qt[j][0], 2 * 26);
+    qt[j][52] = qt[j][53] = qt[j][54] = qt[j][55] = 0;
+  }
+#endif
+}
 
-    q0 += 2;
-    q1 += 2;
+/* Calculate the Q parities for the sector.
+ * The 26 Q vectors of length 43 run diagonally through the rows: word j of
+ * Q vector i is word j of row (i + j) % 26.  With the rows transposed, the
+ * j-th words of all of them are consecutive and are processed like a row in
+ * calc_P_parity().
+ */
+static void calc_Q_parity(u_int8_t *sector)
+{
+  gf8_lanes_t h[GF8_LANE_WORDS(2 * 26)], s0[GF8_LANE_WORDS(2 * 26)];
+  u_int16_t qt[43][64];
+  int i, j;
+
+  transpose_q_rows(sector, qt);
+
+  for (i = 0; i < GF8_LANE_WORDS(2 * 26); i++)
+    h[i] = s0[i] = gf8_lanes_zero();
+
+  for (j = 0; j <= 42; j++) {
+    const u_int8_t *w = (const u_int8_t *)&qt[j][j % 26];
 
-    q_lsb_start += 2 * 43;
+    for (i = 0; i < GF8_LANE_WORDS(2 * 26); i++) {
+      const gf8_lanes_t d = gf8_lanes_load(w + i * GF8_LANES);
+
+      h[i] = gf8_lanes_xor(gf8_lanes_mul_a(h[i]), d);
+      s0[i] = gf8_lanes_xor(s0[i], d);
+    }
   }
+
+  store_parity(h, s0, 2 * 26,
+	       sector + LEC_MODE1_Q_PARITY_OFFSET + 2 * 26,
+	       sector + LEC_MODE1_Q_PARITY_OFFSET);
 }
 
 /* Encodes a MODE 0 sector.
@@ -505,6 +626,29 @@ void lec_encode_mode1_sector(u_int32_t adr, u_int8_t *sector)
   calc_Q_parity(sector);
 }
 
+/* Encodes a MODE 1 sector without the P and Q parities, for consumers that
+ * only look at the user data and the EDC.
+ */
+void lec_encode_mode1_sector_no_ecc(u_int32_t adr, u_int8_t *sector)
+{
+  set_sync_pattern(sector);
+  set_sector_header(1, adr, sector);
+
+  calc_mode1_edc(sector);
+
+  memset(sector + LEC_MODE1_INTERMEDIATE_OFFSET, 0,
+	 2352 - LEC_MODE1_INTERMEDIATE_OFFSET);
+}
+
+/* Recalculates the P and Q parity of a MODE 1 sector from its header and
+ * data as they stand.
+ */
+void lec_generate_mode1_ecc(u_int8_t *sector)
+{
+  calc_P_parity(sector);
+  calc_Q_parity(sector);
+}
+
 /* Encodes a MODE 2 sector.
  * 'adr' is the current physical sector address
  * 'sector' must be 2352 byte wide containing 2336 bytes user data at
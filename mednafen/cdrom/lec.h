@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <stdint.h>
 
+typedef uint64_t u_int64_t;
 typedef uint32_t u_int32_t;
 typedef uint16_t u_int16_t;
 typedef uint8_t u_int8_t;
@@ -48,6 +49,17 @@ void lec_encode_mode0_sector(u_int32_t adr, u_int8_t *sector);
  */
 void lec_encode_mode1_sector(u_int32_t adr, u_int8_t *sector);
 
+/* Like lec_encode_mode1_sector(), but leaves out the P and Q parity(which is
+ * zeroed); the EDC is still valid.
+ */
+void lec_encode_mode1_sector_no_ecc(u_int32_t adr, u_int8_t *sector);
+
+/* Recalculates only the P and Q parity of a mode 1 sector, from its header
+ * and data as they stand.
+ * 'sector' must be 2352 byte wide
+ */
+void lec_generate_mode1_ecc(u_int8_t *sector);
+
 /* Encodes a MODE 2 sector.
  * 'adr' is the current physical sector address
  * 'sector' must be 2352 byte wide containing 2336 bytes user data at
@@ -69,6 +81,10 @@ void lec_encode_mode2_form1_sector(u_int32_t adr, u_int8_t *sector);
  */
 void lec_encode_mode2_form2_sector(u_int32_t adr, u_int8_t *sector);
 
+/* Calculates the EDC (CD-ROM CRC32) of 'len' bytes at 'data'.
+ */
+u_int32_t lec_calc_edc(const u_int8_t *data, int len);
+
 /* Scrambles and byte swaps an encoded sector.
  * 'sector' must be 2352 byte wide.
  */
@@ -113,6 +113,7 @@ static ADSynth ADPCMSynth;
 static OKIADPCM_Decoder<OKIADPCM_MSM5205> MSM5205;
 
 static bool ADPCMLP;
+static bool ADPCMEnabled = true;
 typedef struct
 {
  uint8    *RAM;	// = NULL; //0x10000;
@@ -425,10 +426,17 @@ bool PCECD_SetSettings(const PCECD_Settings *settings)
         ADPCMLP = settings ? settings->ADPCM_LPF : 0;
 
 	SCSICD_SetTransferRate(126000 * (settings ? settings->CD_Speed : 1));
+	SCSICD_SetFastRead(settings ? settings->Fast_Read_Multiplier : 0);
 
 	return true;
 }
 
+void PCECD_SetChanEnableMask(uint64 mask)
+{
+	ADPCMEnabled = (mask >> 0) & 1;
+	SCSICD_SetCDDAEnable((mask >> 1) & 1);
+}
+
 bool PCECD_Init(const PCECD_Settings *settings, void (*irqcb)(bool), double master_clock, unsigned int ocm, Blip_Buffer *soundbuf_l, Blip_Buffer *soundbuf_r)
 {
 	lastts = 0;
@@ -442,6 +450,7 @@ bool PCECD_Init(const PCECD_Settings *settings, void (*irqcb)(bool), double mast
 
 	// Warning: magic number 126000 in PCECD_SetSettings() too
 	SCSICD_Init(SCSICD_PCE, 3 * OC_Multiplier, sbuf[0], sbuf[1], 126000 * (settings ? settings->CD_Speed : 1), master_clock * OC_Multiplier, CDIRQ, StuffSubchannel);
+	SCSICD_SetFastRead(settings ? settings->Fast_Read_Multiplier : 0);
 
         if(!(ADPCM.RAM = (uint8 *)MDFN_malloc(0x10000, _("PCE ADPCM RAM"))))
         {
@@ -934,10 +943,15 @@ static INLINE void ADPCM_PB_Run(int32 basetime, int32 run_time)
    ADPCM.PlayNibble ^= 4;
 
    pcm = (pcm * ADPCMFadeVolume) >> 8;
-   uint32 synthtime = ((basetime + (ADPCM.bigdiv >> 16))) / (3 * OC_Multiplier);
 
-   if(sbuf[0] && sbuf[1])
+   // Still decoded while muted, since the decoder state carries over.
+   if(!ADPCMEnabled)
+    pcm = 0;
+
+   if(sbuf[0] && sbuf[1] && pcm != ADPCM.last_pcm)
    {
+    uint32 synthtime = ((basetime + (ADPCM.bigdiv >> 16))) / (3 * OC_Multiplier);
+
     ADPCMSynth.offset(synthtime, pcm - ADPCM.last_pcm, sbuf[0]);
     ADPCMSynth.offset(synthtime, pcm - ADPCM.last_pcm, sbuf[1]);
    }
@@ -1021,6 +1035,9 @@ int32 PCECD_Run(uint32 in_timestamp)
  int32 clocks = in_timestamp - lastts;
  int32 running_ts = lastts;
 
+ // Streaming ADPCM(refilled from CD while it plays) keeps CD reads at their nominal speed in fast read mode.
+ SCSICD_SetAudioStreaming(ADPCM.Playing);
+
  //printf("Run Begin: Clocks=%d(%d - %d), cl=%d\n", clocks, in_timestamp, lastts, CalcNextEvent);
  //fflush(stdout);
 
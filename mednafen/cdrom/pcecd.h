@@ -12,6 +12,8 @@ typedef struct
 	double ADPCM_Volume;
 
 	bool ADPCM_LPF;
+
+	unsigned int Fast_Read_Multiplier;	// "Fast CD" mode(see SCSICD_SetFastRead()), 0 to disable.
 } PCECD_Settings;
 
 
@@ -47,6 +49,9 @@ void PCECD_ResetTS(void);
 bool PCECD_Init(const PCECD_Settings *settings, void (*irqcb)(bool), double master_clock, unsigned int ocm, Blip_Buffer *soundbuf_l, Blip_Buffer *soundbuf_r);
 bool PCECD_SetSettings(const PCECD_Settings *settings);
 
+// Bit 0 enables ADPCM output, bit 1 CD-DA output.
+void PCECD_SetChanEnableMask(uint64 mask);
+
 void PCECD_Close();
 
 // Returns number of cycles until next CD event.
@@ -30,6 +30,8 @@ using namespace CDUtility;
 
 
 static uint32 CD_DATA_TRANSFER_RATE;
+static uint32 FastReadMultiplier;	// SCSICD_SetFastRead(); 0 or 1 when off.
+static bool AudioStreaming;		// SCSICD_SetAudioStreaming()
 static uint32 System_Clock;
 static void (*CDIRQCallback)(int);
 static void (*CDStuffSubchannels)(uint8, int);
@@ -164,6 +166,7 @@ static int64 pce_lastsapsp_timestamp;
 scsicd_t cd;
 scsicd_bus_t cd_bus;
 static cdda_t cdda;
+static bool CDDAEnabled = true;
 
 static SimpleFIFO<uint8> *din = NULL;
 
@@ -177,6 +180,18 @@ static int32 CDReadTimer;
 static uint32 SectorAddr;
 static uint32 SectorCount;
 
+// Time to read one data sector(and, as there's no seek time emulation, the time until the first sector of a READ arrives).
+// Fast read mode falls back to the nominal rate whenever a game might be timing audio against the reads.
+static INLINE int32 CalcSectorReadTime(void)
+{
+ uint32 rate = CD_DATA_TRANSFER_RATE;
+
+ if(FastReadMultiplier > 1 && !AudioStreaming && cdda.CDDAStatus != CDDASTATUS_PLAYING && cdda.CDDAStatus != CDDASTATUS_SCANNING)
+  rate *= FastReadMultiplier;
+
+ return((uint64)1 * 2048 * System_Clock / rate);
+}
+
 
 enum
 {
@@ -289,15 +304,9 @@ void SCSICD_SetATN(bool set)
  //printf("Set ATN: %d\n", set);
 }
 
-static void GenSubQFromSubPW(void)
+// SubQBuf is the Q subchannel data of the sector just read, as deinterleaved by CDIF.
+static void UpdateSubQ(const uint8 *SubQBuf)
 {
- uint8 SubQBuf[0xC];
-
- memset(SubQBuf, 0, 0xC);
-
- for(int i = 0; i < 96; i++)
-  SubQBuf[i >> 3] |= ((cd.SubPWBuf[i] & 0x40) >> 6) << (7 - (i & 7));
-
  //printf("Real %d/ SubQ %d - ", read_sec, BCD_to_U8(SubQBuf[7]) * 75 * 60 + BCD_to_U8(SubQBuf[8]) * 75 + BCD_to_U8(SubQBuf[9]) - 150);
  // Debug code, remove me.
  //for(int i = 0; i < 0xC; i++)
@@ -2160,7 +2169,7 @@ static void DoREADBase(uint32 sa, uint32 sc)
  {
   Cur_CDIF->HintReadSector(sa);	//, sa + sc);
 
-  CDReadTimer = (uint64)1 * 2048 * System_Clock / CD_DATA_TRANSFER_RATE;
+  CDReadTimer = CalcSectorReadTime();
  }
  else
  {
@@ -2667,15 +2676,16 @@ static INLINE void RunCDDA(uint32 system_timestamp, int32 run_time)
 
     {
      uint8 tmpbuf[2352 + 96];
+     uint8 subq[0xC];
 
-     Cur_CDIF->ReadRawSector(tmpbuf, read_sec);	//, read_sec_end, read_sec_start);
+     Cur_CDIF->ReadRawSector(tmpbuf, read_sec, subq);	//, read_sec_end, read_sec_start);
 
      for(int i = 0; i < 588 * 2; i++)
       cdda.CDDASectorBuffer[i] = MDFN_de16lsb(&tmpbuf[i * 2]);
 
      memcpy(cd.SubPWBuf, tmpbuf + 2352, 96);
+     UpdateSubQ(subq);
     }
-    GenSubQFromSubPW();
 
     if(cdda.CDDAStatus == CDDASTATUS_SCANNING)
     {
@@ -2703,7 +2713,7 @@ static INLINE void RunCDDA(uint32 system_timestamp, int32 run_time)
    // current sector as audio.
    sample[0] = sample[1] = 0;
 
-   if(!(cd.SubQBuf_Last[0] & 0x40) && cdda.PlayMode != PLAYMODE_SILENT)
+   if(!(cd.SubQBuf_Last[0] & 0x40) && cdda.PlayMode != PLAYMODE_SILENT && CDDAEnabled)
    {
     sample[0] += (cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[0]] * cdda.OutPortVolumeCache[0]) >> 16;
     sample[1] += (cdda.CDDASectorBuffer[cdda.CDDAReadPos * 2 + cdda.OutPortChSelectCache[1]] * cdda.OutPortVolumeCache[1]) >> 16;
@@ -2720,7 +2730,7 @@ static INLINE void RunCDDA(uint32 system_timestamp, int32 run_time)
      CDStuffSubchannels(0x00, subindex);
    }
 
-   if(sbuf[0] && sbuf[1])
+   if(sbuf[0] && sbuf[1] && (sample[0] != cdda.last_sample[0] || sample[1] != cdda.last_sample[1]))
    {
     cdda.CDDASynth[0].offset_inline(synthtime, sample[0] - cdda.last_sample[0], sbuf[0]);
     cdda.CDDASynth[1].offset_inline(synthtime, sample[1] - cdda.last_sample[1], sbuf[1]);
@@ -2747,13 +2757,14 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
     //printf("Carp: %d %d %d\n", din->CanWrite(), SectorCount, CDReadTimer);
     //CDReadTimer = (cd.data_in_size - cd.data_in_pos) * 10;
     
-    CDReadTimer += (uint64) 1 * 2048 * System_Clock / CD_DATA_TRANSFER_RATE;
+    CDReadTimer += CalcSectorReadTime();
 
     //CDReadTimer += (uint64) 1 * 128 * System_Clock / CD_DATA_TRANSFER_RATE;
    }
    else
    {
     uint8 tmp_read_buf[2352 + 96];
+    uint8 tmp_subq[0xC];
 
     if(cd.TrayOpen)
     {
@@ -2766,7 +2777,7 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
     {
      CommandCCError(SENSEKEY_ILLEGAL_REQUEST, NSE_END_OF_VOLUME);
     }
-    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr))	//, SectorAddr + SectorCount))
+    else if(!Cur_CDIF->ReadRawSector(tmp_read_buf, SectorAddr, tmp_subq))	//, SectorAddr + SectorCount))
     {
      cd.data_transfer_done = FALSE;
 
@@ -2781,7 +2792,7 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
      else
       din->Write(tmp_read_buf + 16, 2048);
 
-     GenSubQFromSubPW();
+     UpdateSubQ(tmp_subq);
 
      CDIRQCallback(SCSICD_IRQ_DATA_TRANSFER_READY);
 
@@ -2794,7 +2805,7 @@ static INLINE void RunCDRead(uint32 system_timestamp, int32 run_time)
      if(SectorCount)
      {
       cd.data_transfer_done = FALSE;
-      CDReadTimer += (uint64) 1 * 2048 * System_Clock / CD_DATA_TRANSFER_RATE;
+      CDReadTimer += CalcSectorReadTime();
      }
      else
      {
@@ -3070,6 +3081,16 @@ void SCSICD_SetTransferRate(uint32 TransferRate)
  CD_DATA_TRANSFER_RATE = TransferRate;
 }
 
+void SCSICD_SetFastRead(uint32 multiplier)
+{
+ FastReadMultiplier = multiplier;
+}
+
+void SCSICD_SetAudioStreaming(bool active)
+{
+ AudioStreaming = active;
+}
+
 void SCSICD_Close(void)
 {
  if(din)
@@ -3084,6 +3105,9 @@ void SCSICD_Init(int type, int cdda_time_div, Blip_Buffer *leftbuf, Blip_Buffer
  Cur_CDIF = NULL;
  cd.TrayOpen = false;
 
+ FastReadMultiplier = 0;
+ AudioStreaming = false;
+
  monotonic_timestamp = 0;
  lastts = 0;
 
@@ -3116,6 +3140,11 @@ void SCSICD_Init(int type, int cdda_time_div, Blip_Buffer *leftbuf, Blip_Buffer
  CDStuffSubchannels = SSCFunc;
 }
 
+void SCSICD_SetCDDAEnable(bool enable)
+{
+ CDDAEnabled = enable;
+}
+
 void SCSICD_SetCDDAVolume(double left, double right)
 {
  cdda.CDDAVolume[0] = 65536 * left;
@@ -93,7 +93,14 @@ void SCSICD_Init(int type, int CDDATimeDiv, Blip_Buffer *leftbuf, Blip_Buffer *r
 void SCSICD_Close(void);
 
 void SCSICD_SetTransferRate(uint32 TransferRate);
+
+// "Fast CD" mode: data sectors are read at "multiplier" times the transfer rate, except while CD-DA is playing or the
+// system-specific code has audio streaming going(which games may time against the reads).  0 or 1 turns it off.
+void SCSICD_SetFastRead(uint32 multiplier);
+void SCSICD_SetAudioStreaming(bool active);
+
 void SCSICD_SetCDDAVolume(double left, double right);
+void SCSICD_SetCDDAEnable(bool enable);	// Muting only; playback, and subchannel data, carry on as normal.
 int SCSICD_StateAction(StateMem *sm, int load, int data_only, const char *sname);
 
 void SCSICD_SetDisc(bool tray_open, CDIF *cdif, bool no_emu_side_effects = false);
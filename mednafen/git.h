@@ -175,6 +175,12 @@ typedef struct
 	// Will be set to TRUE on the first call to the Emulate() function/method
 	bool VideoFormatChanged;
 
+	// Optional palette, set by the driver code; NULL if unwanted.  If surface->format.colorspace is MDFN_COLORSPACE_INDEXED,
+	// the emulation code writes palette indices to the surface instead of colors, and fills this in with the color of each
+	// index at the end of every frame.  The number of entries is system-specific(1024 for the PC Engine: the 512 VCE colors,
+	// followed by the same 512 colors as shown in black and white mode).
+	MDFN_PaletteEntry *Palette;
+
 	// Set by the system emulation code every frame, to denote the horizontal and vertical offsets of the image, and the size
 	// of the image.  If the emulated system sets the elements of LineWidths, then the horizontal offset(x) and width(w) of this structure
 	// are ignored while drawing the image.
@@ -186,6 +192,12 @@ typedef struct
 	// you can ignore this.  If you do wish to use this, you must set all elements every frame.
 	MDFN_Rect *LineWidths;
 
+	// Optional bitmap with one bit per framebuffer line((fb_height + 31) / 32 elements), set by the driver code; NULL if unwanted.
+	// On frames that aren't skipped, the emulation code sets the bit of every line whose output differs from what it drew on
+	// that line in the previous non-skipped frame, and clears all the others.  Lines are compared by 64-bit hash(MDFN_HashLine()),
+	// which is treated as exact: a collision, and with it a missed change, is possible but vanishingly unlikely.
+	uint32 *LineDirty;
+
 	// TODO
 	bool *IsFMV;
 
@@ -293,7 +305,7 @@ typedef struct
  void (*SetLayerEnableMask)(uint64 mask);	// Video
  const char *LayerNames;
 
- void (*SetChanEnableMask)(uint64 mask);	// Audio(TODO, placeholder)
+ void (*SetChanEnableMask)(uint64 mask);	// Audio
  const char *ChanNames;
 
  void (*InstallReadPatch)(uint32 address);
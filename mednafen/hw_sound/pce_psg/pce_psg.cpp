@@ -29,6 +29,16 @@ void PCE_PSG::SetVolume(double new_volume)
  Synth.volume(OutputVolume / 6);
 }
 
+void PCE_PSG::SetChanEnableMask(uint32 mask)
+{
+ // The output of the changed channels is brought up to date on their next RunChannel().
+ chan_output_stale |= (chan_enable_mask ^ mask) & 0x3F;
+ chan_enable_mask = mask;
+
+ for(int chnum = 0; chnum < 6; chnum++)
+  RecalcUOFunc(chnum);
+}
+
 // Note: Changing the 0x1F(not that there should be) would require changing the channel pseudo-off volume check logic later on.
 static const int scale_tab[] = 
 {
@@ -103,7 +113,9 @@ void PCE_PSG::RecalcUOFunc(int chnum)
 
  //printf("UO Update: %d, %02x\n", chnum, ch->control);
 
- if((revision != REVISION_HUC6280 && !(ch->control & 0xC0)) || (revision == REVISION_HUC6280 && !(ch->control & 0x80)))
+ if(!(chan_enable_mask & (1 << chnum)))
+  ch->UpdateOutput = &PCE_PSG::UpdateOutput_Off;
+ else if((revision != REVISION_HUC6280 && !(ch->control & 0xC0)) || (revision == REVISION_HUC6280 && !(ch->control & 0x80)))
   ch->UpdateOutput = &PCE_PSG::UpdateOutput_Off;
  else if(ch->noisectrl & ch->control & 0x80)
   ch->UpdateOutput = &PCE_PSG::UpdateOutput_Noise;
@@ -310,6 +322,8 @@ PCE_PSG::PCE_PSG(Blip_Buffer *bb_l, Blip_Buffer *bb_r, int want_revision)
 	sbuf[1] = bb_r;
 
 	SoundEnabled = (sbuf[0] && sbuf[1]);
+	chan_enable_mask = ~0U;
+	chan_output_stale = 0;
 
 	lastts = 0;
 	for(int ch = 0; ch < 6; ch++)
@@ -528,6 +542,32 @@ void PCE_PSG::Write(int32 timestamp, uint8 A, uint8 V)
     }
 }
 
+// Adds the output changes for a run of waveform/noise steps, batched up by RunChannel(), to one side's Blip_Buffer.
+// Steps that don't change the output are dropped here, rather than being fed to the synth as zero-deltas.
+void PCE_PSG::SynthSteps(const int32 *db, int32 *prev_samp, const int32 *times, const uint8 *svs, const int count, Blip_Buffer *bb)
+{
+ int32 prev = *prev_samp;
+
+ for(int i = 0; i < count; i++)
+ {
+  const int32 samp = db[svs[i]];
+
+  if(samp != prev)
+  {
+   Synth.offset_inline(times[i], samp - prev, bb);
+   prev = samp;
+  }
+ }
+
+ *prev_samp = prev;
+}
+
+void PCE_PSG::FlushSteps(psg_channel *ch, const int32 *times, const uint8 *svs, const int count)
+{
+ SynthSteps(dbtable[ch->vl[0]], &ch->blip_prev_samp[0], times, svs, count, sbuf[0]);
+ SynthSteps(dbtable[ch->vl[1]], &ch->blip_prev_samp[1], times, svs, count, sbuf[1]);
+}
+
 // Don't use INLINE, which has always_inline in it, due to gcc's inability to cope with the type of recursion
 // used in this function.
 inline void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
@@ -535,6 +575,9 @@ inline void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
  psg_channel *ch = &channel[chc];
  int32 running_timestamp = ch->lastts;
  int32 run_time = timestamp - ch->lastts;
+ int32 step_times[PSG_STEP_BATCH];
+ uint8 step_svs[PSG_STEP_BATCH];
+ int step_count;
 
  ch->lastts = timestamp;
 
@@ -544,22 +587,39 @@ inline void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
  //if(chc != 5)
  // return;
 
- if(REVISION_ENHANCED != revision)
+ if(REVISION_ENHANCED != revision || (chan_output_stale & (1 << chc)))
   (this->*ch->UpdateOutput)(running_timestamp, ch);
 
+ chan_output_stale &= ~(1 << chc);
+
+ // Fully attenuated on both sides, and already at 0: none of the steps below can change the output.
+ const bool silent = ch->vl[0] == 0x1F && ch->vl[1] == 0x1F && !ch->blip_prev_samp[0] && !ch->blip_prev_samp[1];
+
  if(chc >= 4)
  {
   int32 freq = ch->noise_freq_cache;
 
   ch->noisecount -= run_time;
 
-  if(&PCE_PSG::UpdateOutput_Noise == ch->UpdateOutput)
+  if(&PCE_PSG::UpdateOutput_Noise == ch->UpdateOutput && !silent)
+  {
+   step_count = 0;
+
    while(ch->noisecount <= 0)
    {
     CLOCK_LFSR(ch->lfsr);
-    UpdateOutput_Noise(timestamp + ch->noisecount, ch);
+    step_times[step_count] = timestamp + ch->noisecount;
+    step_svs[step_count] = ((ch->lfsr & 1) << 5) - (ch->lfsr & 1);
+    if(++step_count == PSG_STEP_BATCH)
+    {
+     FlushSteps(ch, step_times, step_svs, step_count);
+     step_count = 0;
+    }
     ch->noisecount += freq;
    }
+
+   FlushSteps(ch, step_times, step_svs, step_count);
+  }
   else
    while(ch->noisecount <= 0)
    {
@@ -578,17 +638,48 @@ inline void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
 
  ch->counter -= run_time;
 
- if(!LFO_On && ch->freq_cache <= 0xA)
+ if(!LFO_On)
  {
-  if(ch->counter <= 0)
+  // The noise output was brought up to date above, so at most the first waveform step can change it(and then
+  // only if the volume changed since the last noise step).
+  if(&PCE_PSG::UpdateOutput_Noise == ch->UpdateOutput && ch->counter <= 0)
+   UpdateOutput_Noise(timestamp + ch->counter, ch);
+
+  if(ch->freq_cache <= 0xA || silent || &PCE_PSG::UpdateOutput_Norm != ch->UpdateOutput)
   {
-   const int32 inc_count = ((0 - ch->counter) / ch->freq_cache) + 1;
+   if(ch->counter <= 0)
+   {
+    const int32 inc_count = ((0 - ch->counter) / ch->freq_cache) + 1;
 
-   ch->counter += inc_count * ch->freq_cache;
+    ch->counter += inc_count * ch->freq_cache;
 
-   ch->waveform_index = (ch->waveform_index + inc_count) & 0x1F;
-   ch->dda = ch->waveform[ch->waveform_index];
+    ch->waveform_index = (ch->waveform_index + inc_count) & 0x1F;
+    ch->dda = ch->waveform[ch->waveform_index];
+   }
   }
+  else
+  {
+   step_count = 0;
+
+   while(ch->counter <= 0)
+   {
+    ch->waveform_index = (ch->waveform_index + 1) & 0x1F;
+    ch->dda = ch->waveform[ch->waveform_index];
+
+    step_times[step_count] = timestamp + ch->counter;
+    step_svs[step_count] = ch->dda;
+    if(++step_count == PSG_STEP_BATCH)
+    {
+     FlushSteps(ch, step_times, step_svs, step_count);
+     step_count = 0;
+    }
+    ch->counter += ch->freq_cache;
+   }
+
+   FlushSteps(ch, step_times, step_svs, step_count);
+  }
+
+  return;
  }
 
  while(ch->counter <= 0)
@@ -598,16 +689,11 @@ inline void PCE_PSG::RunChannel(int chc, int32 timestamp, const bool LFO_On)
 
   (this->*ch->UpdateOutput)(timestamp + ch->counter, ch);
 
-  if(LFO_On)
-  {
-   RunChannel(1, timestamp + ch->counter, false);
-   RecalcFreqCache(0);
-   RecalcUOFunc(0);
+  RunChannel(1, timestamp + ch->counter, false);
+  RecalcFreqCache(0);
+  RecalcUOFunc(0);
 
-   ch->counter += (ch->freq_cache <= 0xA) ? 0xA : ch->freq_cache;	// Not particularly accurate, but faster.
-  }
-  else
-   ch->counter += ch->freq_cache;
+  ch->counter += (ch->freq_cache <= 0xA) ? 0xA : ch->freq_cache;	// Not particularly accurate, but faster.
  }
 }
 
@@ -120,6 +120,9 @@ class PCE_PSG
 
 	void SetVolume(double new_volume);
 
+	// Bit n enables channel n.  Disabled channels keep running, they just don't make any sound.
+	void SetChanEnableMask(uint32 mask);
+
 	void EndFrame(int32 timestamp);
 
 	// TODO: timestamp
@@ -151,6 +154,10 @@ class PCE_PSG
 	void RecalcFreqCache(int chnum);
 	void RecalcNoiseFreqCache(int chnum);
 	void RunChannel(int chc, int32 timestamp, bool LFO_On);
+
+	enum { PSG_STEP_BATCH = 64 };
+	void SynthSteps(const int32 *db, int32 *prev_samp, const int32 *times, const uint8 *svs, const int count, Blip_Buffer *bb);
+	void FlushSteps(psg_channel *ch, const int32 *times, const uint8 *svs, const int count);
 	double OutputVolume;
 
         uint8 select;               /* Selected channel (0-5) */
@@ -169,6 +176,8 @@ class PCE_PSG
 	int revision;
 
 	bool SoundEnabled;
+	uint32 chan_enable_mask;
+	uint32 chan_output_stale;
 	Blip_Buffer *sbuf[2];
 	Blip_Synth<blip_good_quality, 8192> Synth;
 
@@ -485,6 +485,48 @@ int VDC::TimeFromBYRLatchToBXRLatch(void)
  return(ret);
 }
 
+// Returns how long the horizontal phases following the current one can run without the CPU being able to tell, so
+// that they needn't be separate events(and lines the CPU doesn't touch take a few large Run() calls rather than many
+// small ones).  Phase changes in that stretch only update internal state, which Run() brings up to date at the exact
+// same clocks whenever the VDC is next synchronized for a register access or an event.
+int32 VDC::QuietHPhaseTime(void)
+{
+ int32 ret = 0;
+
+ // Waiting on a VRAM access, or about to start a DMA whose completion needs to be scheduled as an event.
+ if(VDC_IS_BSY || (DMAPending && burst_mode) || (NeedSATDMATest && VPhase != VPHASE_VDW))
+  return(0);
+
+ // HPHASE_HDS and HPHASE_HDW_FINAL can raise the RCR IRQ, so they always end the stretch.
+ for(int phase = HPhase + 1; phase < HPHASE_COUNT; phase++)
+ {
+  switch(phase)
+  {
+   default: return(ret);
+
+   case HPHASE_HDS_PART2: ret += TimeFromBYRLatchToBXRLatch();
+			  break;
+
+   case HPHASE_HDS_PART3: ret += (HDS_cache + 1) * 8 - TimeFromHDSStartToBYRLatch() - TimeFromBYRLatchToBXRLatch();
+			  break;
+
+   case HPHASE_HDW: // VBlank IRQ test, or sprite #0 hit IRQ while drawing the line.
+		    if(VPhase != VPHASE_VDW ? NeedVBIRQTest : (!burst_mode && (CR & 0x01)))
+		     return(ret);
+		    ret += (HDW_cache + 1) * 8 - Cycles_Between_RCRIRQ_And_HDWEnd;
+		    break;
+
+   case HPHASE_HDE: ret += (HDE_cache + 1) * 8;
+		    break;
+
+   case HPHASE_HSW: ret += (HSW_cache + 1) * 8;
+		    break;
+  }
+ }
+
+ return(ret);
+}
+
 void VDC::HDS_Start(void)
 {
  if(NeedRCRInc)
@@ -580,7 +622,7 @@ int32 VDC::VSync(bool vb)
 }
 
 //int32 VDC::Run(int32 clocks, bool hs, bool vs, uint16 *pixels, bool skip)
-int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
+int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip, const uint32 *color_lut)
 {
  //uint16 *spixels = pixels;
 
@@ -671,13 +713,20 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
   {
    if(!skip)
    {
-    for(int i = 0; i < chunk_clocks; i++)
-     pixels[i] = linebuf[pixel_desu + i];
-    //memcpy(pixels, linebuf + pixel_desu, chunk_clocks * sizeof(uint16));
+    const uint16 *src = linebuf + pixel_desu;
 
-    if(M_vdc_TE == 0x1)
+    if(color_lut)
+    {
+     for(int i = 0; i < chunk_clocks; i++)
+      pixels[i] = color_lut[src[i] & 0x3FF];
+    }
+    else if(M_vdc_TE == 0x1)
+    {
      for(int i = 0; i < chunk_clocks; i++)
-      pixels[i] |= VDC_DISP_OUT_MASK;
+      pixels[i] = src[i] | VDC_DISP_OUT_MASK;
+    }
+    else
+     memcpy(pixels, src, chunk_clocks * sizeof(uint16));
    }
 
    pixel_desu += chunk_clocks;
@@ -709,6 +758,9 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
 
    if(!skip)
    {
+    if(color_lut)
+     pix = color_lut[pix & 0x3FF];
+
     for(int i = 0; i < chunk_clocks; i++)
      pixels[i] = pix;
    }
@@ -769,7 +821,7 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
 		       pixel_copy_count = (HDW_cache + 1) * 8;
 
 		       // BG off, sprite on: fill = 0x100.  bg off, sprite off: fill = 0x000
-		       if(!(CR_cache & 0x80))
+		       if(!skip && !(CR_cache & 0x80))
 		       {
 		        uint16 fill_val;
 
@@ -816,7 +868,8 @@ int32 VDC::Run(int32 clocks, uint16 *pixels, bool skip)
     case HPHASE_HSW: HPhaseCounter = (HSW_cache + 1) * 8; break;
    }
   }
-  pixels += chunk_clocks;
+  if(!skip)	// "pixels" is NULL for skipped lines.
+   pixels += chunk_clocks;
   clocks -= chunk_clocks;
  }
 
@@ -1097,6 +1150,13 @@ void VDC::DrawSprites(uint16 *target, int enabled)
 
  uint32 display_width, start, end;
 
+ // Nothing will be composited, and without sprite #0 hit detection there's nothing to observe.
+ if(!enabled && !(CR & 0x01))
+ {
+  active_sprites = 0;
+  return;
+ }
+
  CalcWidthStartEnd(display_width, start, end);
 
  for(unsigned int i = start; i < end; i++)
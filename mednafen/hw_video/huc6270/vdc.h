@@ -161,7 +161,9 @@ class VDC
         void Write16(bool A, uint16 V);
         uint16 Read16(bool A, bool peek = FALSE);
 
-	int32 Run(int32 clocks, /*bool hs, bool vs,*/ uint16 *pixels, bool skip);
+	// If color_lut is non-NULL, the pixels are passed through it(indexed by the lower 10 bits) as they're output, and
+	// the sync/display signal bits are not output.
+	int32 Run(int32 clocks, /*bool hs, bool vs,*/ uint16 *pixels, bool skip, const uint32 *color_lut = NULL);
 
 
 	void FixTileCache(uint16);
@@ -262,6 +264,7 @@ class VDC
 
 	int TimeFromHDSStartToBYRLatch(void);
 	int TimeFromBYRLatchToBXRLatch(void);
+	int32 QuietHPhaseTime(void);
 
 	enum
 	{
@@ -296,7 +299,7 @@ class VDC
 
 	INLINE int32 CalcNextEvent(void)
 	{
-	 int32 next_event = HPhaseCounter;
+	 int32 next_event = HPhaseCounter + QuietHPhaseTime();
 
 	 if(sat_dma_counter > 0 && sat_dma_counter < next_event)
 	  next_event = sat_dma_counter;
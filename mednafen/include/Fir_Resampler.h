@@ -7,6 +7,11 @@
 #include "blargg_common.h"
 #include <string.h>
 
+#if defined(ARCH_X86) && defined(__SSE2__)
+#include <emmintrin.h>
+#define FIR_RESAMPLER_SSE2 1
+#endif
+
 class Fir_Resampler_ {
 public:
 	
@@ -126,6 +131,30 @@ int Fir_Resampler<width>::read( sample_t* out_begin, blargg_long count )
 			if ( count < 0 )
 				break;
 			
+		#ifdef FIR_RESAMPLER_SSE2
+			if ( width % 4 == 0 )
+			{
+				// Four taps at a time: (l0 l1 r0 r1 l2 l3 r2 r3) * (t0 t1 t0 t1 t2 t3 t2 t3),
+				// pairwise-added by pmaddwd into (l, r, l, r) partial sums.  Wraps exactly
+				// like the 32-bit scalar accumulation below.
+				__m128i acc = _mm_setzero_si128();
+				for ( int n = width / 4; n; --n )
+				{
+					__m128i s = _mm_loadu_si128( (const __m128i*) i );
+					__m128i t = _mm_loadl_epi64( (const __m128i*) imp );
+					s = _mm_shufflelo_epi16( s, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+					s = _mm_shufflehi_epi16( s, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+					t = _mm_unpacklo_epi32( t, t );
+					acc = _mm_add_epi32( acc, _mm_madd_epi16( s, t ) );
+					imp += 4;
+					i += 8;
+				}
+				acc = _mm_add_epi32( acc, _mm_shuffle_epi32( acc, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+				l = _mm_cvtsi128_si32( acc );
+				r = _mm_cvtsi128_si32( _mm_shuffle_epi32( acc, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+			}
+			else
+		#endif
 			for ( int n = width / 2; n; --n )
 			{
 				int pt0 = imp [0];
@@ -50,6 +50,11 @@ public:
 	// easy interleving of two channels into a stereo output buffer.
 	long read_samples( blip_sample_t* dest, long max_samples, int stereo = 0 );
 	
+	// Same as read_samples() with stereo set, on this buffer as the left channel and
+	// 'right' as the right channel, but done in one pass. Both buffers should have the
+	// same sample rate, clock rate and bass frequency.
+	long read_samples_stereo( Blip_Buffer& right, blip_sample_t* dest, long max_samples );
+	
 // Additional optional features
 
 	// Current output sample rate
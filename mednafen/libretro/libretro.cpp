@@ -21,11 +21,16 @@
 #if defined(WANT_PCE_EMU)
 #define WIDTH 680
 #define HEIGHT 480
+#define OPTION(name) "pce_" name
 #elif defined(WANT_PCE_FAST_EMU)
 #define WIDTH 512
 #define HEIGHT 242
+#define OPTION(name) "pce_fast_" name
 #endif
 
+// Frames skipped out of every (AUTO_FRAMESKIP + 1) while the frontend fast-forwards.
+#define AUTO_FRAMESKIP 3
+
 static MDFNGI *game;
 static retro_video_refresh_t video_cb;
 static retro_audio_sample_t audio_cb;
@@ -35,8 +40,19 @@ static retro_input_poll_t input_poll_cb;
 static retro_input_state_t input_state_cb;
 
 static MDFN_Surface *surf;
+static const uint16_t *video_frame;
+static unsigned video_width, video_height;
+
+static bool can_dupe;
+static unsigned sample_rate = 44100;	// Blip_Buffer synthesizes straight to this rate
+static int frameskip;	// -1 for auto
+static int frames_skipped;
+
 char g_rom_dir[1024];
 char g_basename[1024];
+bool g_cd_preload;	// Read at load time; the whole CD image is then loaded into RAM in the background
+bool g_cd_skip_ecc;	// Read at load time; MODE1 image sectors are then built without the P/Q ECC bytes
+unsigned g_cd_fast_read;	// Read at load time; CD data read speed multiplier outside CD-DA/ADPCM playback, 0 = off
 
 #ifdef _MSC_VER
 static unsigned short mednafen_buf[WIDTH * HEIGHT];
@@ -121,6 +137,28 @@ int MDFND_UnlockMutex(MDFN_Mutex *lock)
    return 0;
 }
 
+MDFN_Cond *MDFND_CreateCond()
+{
+   return (MDFN_Cond*)scond_new();
+}
+
+void MDFND_DestroyCond(MDFN_Cond *cond)
+{
+   scond_free((scond_t*)cond);
+}
+
+int MDFND_WaitCond(MDFN_Cond *cond, MDFN_Mutex *lock)
+{
+   scond_wait((scond_t*)cond, (slock_t*)lock);
+   return 0;
+}
+
+int MDFND_SignalCond(MDFN_Cond *cond)
+{
+   scond_signal((scond_t*)cond);
+   return 0;
+}
+
 static void extract_basename(char *buf, const char *path, size_t size)
 {
    const char *base = strrchr(path, '/');
@@ -155,6 +193,81 @@ static void extract_directory(char *buf, const char *path, size_t size)
       buf[0] = '\0';
 }
 
+static void check_variables(void)
+{
+   struct retro_variable var;
+
+   var.key = OPTION("frameskip");
+   var.value = NULL;
+
+   frameskip = 0;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (!strcmp(var.value, "auto"))
+         frameskip = -1;
+      else
+         frameskip = atoi(var.value);
+   }
+
+   var.key = OPTION("sample_rate");
+   var.value = NULL;
+
+   sample_rate = 44100;
+
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+      sample_rate = atoi(var.value);
+
+   // Channel mask bits: PSG channels 0-5, then ADPCM and CD-DA.
+   static const struct { const char *key; uint64 bits; } chan_vars[] = {
+      { OPTION("psg_audio"), 0x3F },
+      { OPTION("adpcm_audio"), 0x40 },
+      { OPTION("cdda_audio"), 0x80 },
+   };
+   uint64 chan_mask = ~0ULL;
+
+   for (unsigned i = 0; i < sizeof(chan_vars) / sizeof(chan_vars[0]); i++)
+   {
+      var.key = chan_vars[i].key;
+      var.value = NULL;
+
+      if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "disabled"))
+         chan_mask &= ~chan_vars[i].bits;
+   }
+
+   MDFNI_SetChanEnableMask(chan_mask);
+}
+
+// Skipped frames leave the surface untouched, so the previous frame can be
+// handed to the frontend again if it is unable to dupe.
+static bool should_skip_frame(void)
+{
+   if (!video_frame)
+      return false;
+
+   int av_enable = 0;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) && !(av_enable & 1))
+      return true;
+
+   int skip = frameskip;
+
+   if (skip < 0)
+   {
+      bool fastforward = false;
+      environ_cb(RETRO_ENVIRONMENT_GET_FASTFORWARDING, &fastforward);
+      skip = fastforward ? AUTO_FRAMESKIP : 0;
+   }
+
+   if (frames_skipped < skip)
+   {
+      frames_skipped++;
+      return true;
+   }
+
+   frames_skipped = 0;
+   return false;
+}
+
 void retro_init()
 {
    MDFN_PixelFormat pix_fmt(MDFN_COLORSPACE_RGB, 16, 8, 0, 24);
@@ -224,6 +337,17 @@ bool retro_load_game(const struct retro_game_info *info)
 
    MDFNI_Initialize(g_rom_dir);
 
+   struct retro_variable var = { OPTION("cd_preload"), NULL };
+   g_cd_preload = environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "enabled");
+
+   var.key = OPTION("cd_skip_ecc");
+   var.value = NULL;
+   g_cd_skip_ecc = environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "enabled");
+
+   var.key = OPTION("cd_fast_read");
+   var.value = NULL;
+   g_cd_fast_read = (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value) ? atoi(var.value) : 0;	// "disabled" -> 0
+
 #ifdef WANT_PCE_FAST_EMU
    game = MDFNI_LoadGame("pce_fast", info->path);
 #else
@@ -232,6 +356,20 @@ bool retro_load_game(const struct retro_game_info *info)
 
    update_input();
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe))
+      can_dupe = false;
+
+   video_frame = NULL;
+   frames_skipped = 0;
+   check_variables();
+
+   // Native 5MHz mode until the first frame reports otherwise.
+   if (game)
+   {
+      video_width  = 256;
+      video_height = game->nominal_height;
+   }
+
    return game;
 }
 
@@ -240,37 +378,138 @@ void retro_unload_game()
    MDFNI_CloseGame();
 }
 
+// Both cores write every line at its native dot clock width(256, 341 or 512),
+// all of which span the same visible area, though the accurate core places the
+// visible part of each line at an offset that depends on the dot clock.  Move
+// the visible lines to the left edge, and on the rare frame that changes dot
+// clock mid-screen, widen the narrower lines so the frontend still gets a
+// single-width image to scale.
+static unsigned merge_line_widths(uint16_t *pix, const MDFN_Rect *lw, const MDFN_Rect &rect)
+{
+   static uint16_t line_buf[WIDTH];
+   unsigned width = 0;
+
+   for (int y = rect.y; y < rect.y + rect.h; y++)
+      if ((unsigned)lw[y].w > width)
+         width = lw[y].w;
+
+   for (int y = rect.y; y < rect.y + rect.h; y++)
+   {
+      const unsigned line_w = lw[y].w;
+      uint16_t *line = pix + y * WIDTH;
+
+      if (!line_w)
+         continue;
+
+      if (line_w == width)
+      {
+         if (lw[y].x)
+            memmove(line, line + lw[y].x, width * sizeof(uint16_t));
+         continue;
+      }
+
+      memcpy(line_buf, line + lw[y].x, line_w * sizeof(uint16_t));
+
+      for (unsigned x = 0; x < width; x++)
+         line[x] = line_buf[x * line_w / width];
+   }
+
+   return width;
+}
+
+static void update_geometry(unsigned width, unsigned height)
+{
+   if (width == video_width && height == video_height)
+      return;
+
+   video_width  = width;
+   video_height = height;
+
+   struct retro_game_geometry geom;
+   geom.base_width   = width;
+   geom.base_height  = height;
+   geom.max_width    = WIDTH;
+   geom.max_height   = HEIGHT;
+   geom.aspect_ratio = 4.0 / 3.0;
+
+   environ_cb(RETRO_ENVIRONMENT_SET_GEOMETRY, &geom);
+}
+
 void retro_run()
 {
+   bool updated = false;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
+   {
+      unsigned old_sample_rate = sample_rate;
+
+      check_variables();
+
+      if (sample_rate != old_sample_rate)
+      {
+         struct retro_system_av_info av_info;
+
+         retro_get_system_av_info(&av_info);
+         environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &av_info);
+      }
+   }
+
    input_poll_cb();
    update_input();
 
    static int16_t sound_buf[0x10000];
    static MDFN_Rect rects[HEIGHT];
+   static uint32_t line_dirty[(HEIGHT + 31) / 32];
+
+   // Frontends that won't use the audio get none; the cores then skip all sound synthesis.
+   int av_enable = 0;
+   bool want_audio = !environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) || ((av_enable & 2) && !(av_enable & 8));
 
    EmulateSpecStruct spec = {0}; 
    spec.surface = surf;
-   spec.SoundRate = 44100;
-   spec.SoundBuf = sound_buf;
+   spec.SoundRate = sample_rate;
+   spec.SoundBuf = want_audio ? sound_buf : NULL;
    spec.LineWidths = rects;
+   spec.LineDirty = line_dirty;
    spec.SoundBufMaxSize = sizeof(sound_buf) / 2;
    spec.SoundVolume = 1.0;
    spec.soundmultiplier = 1.0;
+   spec.skip = should_skip_frame();
 
    MDFNI_Emulate(&spec);
 
-#ifdef WANT_PCE_FAST_EMU
-   unsigned width = rects->w;
-   unsigned height = rects->h;
-#else
-   unsigned width = 320;
-   unsigned height = 240;
-#endif
+   // A rendered frame with no changed lines(per the cores' 64-bit line hashes, which are taken as exact) and the same
+   // visible area can be duped just like a skipped one.
+   bool dupe = spec.skip;
 
-   const uint16_t *pix = surf->pixels16;
-   video_cb(pix, width, height, WIDTH << 1);
+   if (!spec.skip)
+   {
+      dupe = true;
+      for (unsigned i = 0; i < sizeof(line_dirty) / sizeof(line_dirty[0]); i++)
+      {
+         if (line_dirty[i])
+         {
+            dupe = false;
+            break;
+         }
+      }
+
+      const MDFN_Rect &rect = spec.DisplayRect;
+      unsigned width = merge_line_widths(surf->pixels16, rects, rect);
+
+      const uint16_t *frame = surf->pixels16 + rect.y * WIDTH;
+
+      if (frame != video_frame || width != video_width || (unsigned)rect.h != video_height)
+         dupe = false;
+
+      update_geometry(width, rect.h);
 
-   audio_batch_cb(spec.SoundBuf, spec.SoundBufSize);
+      video_frame = frame;
+   }
+
+   video_cb((dupe && can_dupe) ? NULL : video_frame, video_width, video_height, WIDTH << 1);
+
+   if (want_audio)
+      audio_batch_cb(spec.SoundBuf, spec.SoundBufSize);
 }
 
 void retro_get_system_info(struct retro_system_info *info)
@@ -283,7 +522,7 @@ void retro_get_system_info(struct retro_system_info *info)
 #endif
    info->library_version  = "v0.9.24";
    info->need_fullpath    = true;
-   info->valid_extensions = "pce|PCE|cue|CUE|zip|ZIP";
+   info->valid_extensions = "pce|PCE|cue|CUE|chd|CHD|zip|ZIP";
    info->block_extract    = false;
 }
 
@@ -291,10 +530,10 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
 {
    memset(info, 0, sizeof(*info));
    // PCE refresh rate: 7159090.90909090 / 455 / 263 = 59.826
-   info->timing.fps            = 59.82;
-   info->timing.sample_rate    = 44100;
-   info->geometry.base_width   = game->nominal_width;
-   info->geometry.base_height  = game->nominal_height;
+   info->timing.fps            = 7159090.90909090 / 455 / 263;
+   info->timing.sample_rate    = sample_rate;
+   info->geometry.base_width   = video_width;
+   info->geometry.base_height  = video_height;
    info->geometry.max_width    = WIDTH;
    info->geometry.max_height   = HEIGHT;
    info->geometry.aspect_ratio = 4.0 / 3.0;
@@ -316,7 +555,21 @@ void retro_set_controller_port_device(unsigned, unsigned)
 
 void retro_set_environment(retro_environment_t cb)
 {
+   static const struct retro_variable vars[] = {
+      { OPTION("frameskip"), "Frameskip; 0|1|2|3|4|5|6|7|8|9|auto" },
+      { OPTION("sample_rate"), "Audio sample rate; 44100|48000|32000|96000|22050" },
+      { OPTION("psg_audio"), "PSG audio; enabled|disabled" },
+      { OPTION("adpcm_audio"), "ADPCM audio; enabled|disabled" },
+      { OPTION("cdda_audio"), "CD-DA audio; enabled|disabled" },
+      { OPTION("cd_preload"), "Preload CD image into RAM (restart); disabled|enabled" },
+      { OPTION("cd_skip_ecc"), "Skip CD sector ECC synthesis (restart); disabled|enabled" },
+      { OPTION("cd_fast_read"), "Fast CD loading (restart); disabled|2x|4x|8x|16x" },
+      { NULL, NULL },
+   };
+
    environ_cb = cb;
+
+   cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)vars);
 }
 
 void retro_set_audio_sample(retro_audio_sample_t cb)
@@ -288,6 +288,8 @@ enum retro_key
 };
 
 // Environment commands.
+#define RETRO_ENVIRONMENT_EXPERIMENTAL 0x10000     // Environment commands which are not yet considered stable
+                                           // are or'ed with this flag.
 #define RETRO_ENVIRONMENT_SET_ROTATION  1  // const unsigned * --
                                            // Sets screen rotation of graphics.
                                            // Is only implemented if rotation can be accelerated by hardware.
@@ -357,6 +359,81 @@ enum retro_key
                                            // If the call returns false, the frontend does not support this pixel format.
                                            // This function should be called inside retro_load_game() or retro_get_system_av_info().
 
+#define RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE 17
+                                           // bool * --
+                                           // Result is set to true if some variables are updated by
+                                           // frontend since last call to RETRO_ENVIRONMENT_GET_VARIABLE.
+                                           // Variables should be queried with GET_VARIABLE.
+                                           //
+#define RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO 32
+                                           // const struct retro_system_av_info * --
+                                           // Sets a new av_info structure. This can only be called from within retro_run().
+                                           // This should *only* be used if the core is completely altering the
+                                           // internal resolutions, aspect ratios, timings, sampling rate, etc.
+                                           // Calling this can require a full reinitialization of video/audio drivers in the frontend,
+                                           // so it is important to call it very sparingly, and usually only with the users explicit consent.
+                                           //
+#define RETRO_ENVIRONMENT_SET_GEOMETRY 37
+                                           // const struct retro_game_geometry * --
+                                           // This environment call is similar to SET_SYSTEM_AV_INFO for changing video parameters,
+                                           // but provides a guarantee that drivers will not be reinitialized.
+                                           // This can only be called from within retro_run().
+                                           //
+                                           // The purpose of this call is to allow a core to alter nominal width/heights as well as aspect ratios on-the-fly,
+                                           // which can be useful for some emulators to change in run-time.
+                                           //
+                                           // max_width/max_height arguments are ignored and cannot be changed with this call
+                                           // as this could potentially require a reinitialization or a non-constant time operation.
+                                           // If max_width/max_height are to be changed, SET_SYSTEM_AV_INFO is required.
+                                           //
+                                           // A frontend must guarantee that this environment call completes in constant time.
+                                           //
+#define RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE (47 | RETRO_ENVIRONMENT_EXPERIMENTAL)
+                                           // int * --
+                                           // Tells the core if the frontend wants audio or video.
+                                           // If disabled, the frontend will discard the audio or video,
+                                           // so the core may decide to skip generating a frame or generating audio.
+                                           // This is mainly used for increasing performance.
+                                           // Bit 0 (value 1): Enable Video
+                                           // Bit 1 (value 2): Enable Audio
+                                           // Bit 2 (value 4): Use Fast Savestates.
+                                           // Bit 3 (value 8): Hard Disable Audio
+                                           // Other bits are reserved for future use and will default to zero.
+                                           // If video is disabled:
+                                           // * The frontend wants the core to not generate any video,
+                                           //   including presenting frames via hardware acceleration.
+                                           // * The frontend's video frame callback will do nothing.
+                                           // * After running the frame, the video output of the next frame should be
+                                           //   no different than if video was enabled, and saving and loading state
+                                           //   should have no issues.
+                                           // If audio is disabled:
+                                           // * The frontend wants the core to not generate any audio.
+                                           // * The frontend's audio callbacks will do nothing.
+                                           // * After running the frame, the audio output of the next frame should be
+                                           //   no different than if audio was enabled, and saving and loading state
+                                           //   should have no issues.
+                                           // Fast Savestates:
+                                           // * Guaranteed to be created by the same binary that will load them.
+                                           // * Will not be written to or read from the disk.
+                                           // * Suggest that the core assumes loading state will succeed.
+                                           // * Suggest that the core updates its memory buffers in-place if possible.
+                                           // * Suggest that the core skips clearing memory.
+                                           // * Suggest that the core skips resetting the system.
+                                           // * Suggest that the core may skip validation steps.
+                                           // Hard Disable Audio:
+                                           // * Used for a secondary core when running ahead.
+                                           // * Indicates that the frontend will never need audio from the core.
+                                           // * Suggests that the core may stop synthesizing audio, but this should not
+                                           //   compromise emulation accuracy.
+                                           // * Audio output for the next frame does not matter, and the frontend will
+                                           //   never need an accurate audio state in the future.
+                                           // * State will never be saved when using Hard Disable Audio.
+                                           //
+#define RETRO_ENVIRONMENT_GET_FASTFORWARDING 49
+                                           // bool * --
+                                           // Boolean value that indicates whether or not the frontend is in
+                                           // fastforwarding mode.
+
 enum retro_pixel_format
 {
    RETRO_PIXEL_FORMAT_0RGB1555 = 0, // 0RGB1555, native endian. 0 bit must be set to 0.
@@ -238,7 +238,11 @@ MDFNGI *MDFNI_LoadCD(const char *force_module, const char *devicename)
   layout_md5.finish(LayoutMD5);
  }
 
+#ifdef WANT_PCE_FAST_EMU
  MDFNGameInfo = &EmulatedPCE_Fast;
+#else
+ MDFNGameInfo = &EmulatedPCE;
+#endif
 
  MDFN_printf(_("Using module: %s(%s)\n\n"), MDFNGameInfo->shortname, MDFNGameInfo->fullname);
 
@@ -257,6 +261,7 @@ MDFNGI *MDFNI_LoadCD(const char *force_module, const char *devicename)
  }
 
  MDFNI_SetLayerEnableMask(~0ULL);
+ MDFNI_SetChanEnableMask(~0ULL);
 
   last_sound_rate = -1;
   memset(&last_pixel_format, 0, sizeof(MDFN_PixelFormat));
@@ -269,14 +274,18 @@ MDFNGI *MDFNI_LoadGame(const char *force_module, const char *name)
         MDFNFILE GameFile;
 	struct stat stat_buf;
 
-	if(strlen(name) > 4 && (!strcasecmp(name + strlen(name) - 4, ".cue") || !strcasecmp(name + strlen(name) - 4, ".toc") || !strcasecmp(name + strlen(name) - 4, ".m3u")))
+	if(strlen(name) > 4 && (!strcasecmp(name + strlen(name) - 4, ".cue") || !strcasecmp(name + strlen(name) - 4, ".toc") || !strcasecmp(name + strlen(name) - 4, ".chd") || !strcasecmp(name + strlen(name) - 4, ".m3u")))
 	 return(MDFNI_LoadCD(force_module, name));
 	
 	MDFNI_CloseGame();
 
 	LastSoundMultiplier = 1;
 
+#ifdef WANT_PCE_FAST_EMU
 	MDFNGameInfo = &EmulatedPCE_Fast;
+#else
+	MDFNGameInfo = &EmulatedPCE;
+#endif
 
 	MDFN_printf(_("Loading %s...\n"),name);
 
@@ -302,6 +311,7 @@ MDFNGI *MDFNI_LoadGame(const char *force_module, const char *name)
         }
 
 	MDFNI_SetLayerEnableMask(~0ULL);
+	MDFNI_SetChanEnableMask(~0ULL);
 
 	if(!MDFNGameInfo->name)
         {
@@ -362,10 +372,7 @@ static void ProcessAudio(EmulateSpecStruct *espec)
   if(multiplier_save != 1)
   {
     if(MDFNGameInfo->soundchan == 2)
-    {
-     for(int i = 0; i < SoundBufSize * 2; i++)
-      ff_resampler.buffer()[i] = SoundBuf[i];
-    }
+     memcpy(ff_resampler.buffer(), SoundBuf, SoundBufSize * 2 * sizeof(int16));
     else
     {
      for(int i = 0; i < SoundBufSize; i++)
@@ -513,6 +520,12 @@ void MDFNI_SetLayerEnableMask(uint64 mask)
   MDFNGameInfo->SetLayerEnableMask(mask);
 }
 
+void MDFNI_SetChanEnableMask(uint64 mask)
+{
+ if(MDFNGameInfo && MDFNGameInfo->SetChanEnableMask)
+  MDFNGameInfo->SetChanEnableMask(mask);
+}
+
 void MDFNI_SetInput(int port, const char *type, void *ptr, uint32 ptr_len_thingy)
 {
  if(MDFNGameInfo)
@@ -527,6 +540,9 @@ void MDFNI_SetInput(int port, const char *type, void *ptr, uint32 ptr_len_thingy
 
 extern char g_rom_dir[1024];
 extern char g_basename[1024];
+extern bool g_cd_preload;
+extern bool g_cd_skip_ecc;
+extern unsigned g_cd_fast_read;
 
 uint64 MDFN_GetSettingUI(const char *name)
 {
@@ -534,6 +550,8 @@ uint64 MDFN_GetSettingUI(const char *name)
 		return 1;
 	if(!strcmp(PCE_MODULE".cdspeed", name))
 		return 2;
+	if(!strcmp(PCE_MODULE".fastcd", name))
+		return g_cd_fast_read;
 	if(!strcmp(PCE_MODULE".cdpsgvolume", name))
 		return 100;
 	if(!strcmp(PCE_MODULE".cddavolume", name))
@@ -544,6 +562,8 @@ uint64 MDFN_GetSettingUI(const char *name)
 		return 4;
 	if(!strcmp(PCE_MODULE".slend", name))
 		return 235;
+	if(!strcmp(PCE_MODULE".vramsize", name))
+		return 32768;
         fprintf(stderr, "Unhandled setting UI: %s\n", name);
 	assert(0);
 	return 0;
@@ -551,6 +571,8 @@ uint64 MDFN_GetSettingUI(const char *name)
 
 int64 MDFN_GetSettingI(const char *name)
 {
+   if(!strcmp(PCE_MODULE".psgrevision", name))
+	   return 1;	// PCE_PSG::REVISION_HUC6280A, the default.
    fprintf(stderr, "Unhandled setting I: %s\n", name);
    assert(0);
    return 0;
@@ -587,8 +609,18 @@ if(!strcmp("cheats", name))
 		return 0;
 	if(!strcmp(PCE_MODULE".correct_aspect", name))
 		return 1;
+	if(!strcmp(PCE_MODULE".h_overscan", name))
+		return 0;
+	if(!strcmp(PCE_MODULE".disable_bram_hucard", name))
+		return 0;
+	if(!strcmp(PCE_MODULE".disable_bram_cd", name))
+		return 0;
 	if(!strcmp("cdrom.lec_eval", name))
 		return 1;
+	if(!strcmp("cdrom.preload", name))
+		return g_cd_preload;
+	if(!strcmp("cdrom.skip_ecc", name))
+		return g_cd_skip_ecc;
 	if(!strcmp("filesys.untrusted_fip_check", name))
 		return 0;
 	fprintf(stderr, "unhandled setting B: %s\n", name);
@@ -603,6 +635,8 @@ std::string MDFN_GetSettingS(const char *name)
                 fprintf(stderr, "%s.cdbios: %s\n", PCE_MODULE, std::string("syscard3.pce").c_str());
 		return std::string("syscard3.pce");
         }
+	if(!strcmp(PCE_MODULE".gecdbios", name))
+		return std::string("gecard.pce");
 	if(!strcmp("filesys.path_firmware", name))
         {
                 fprintf(stderr, "filesys.path_firmware: %s\n", std::string(g_rom_dir).c_str());
@@ -2096,7 +2130,7 @@ static bool SeekToOurSection(FILE *fp) // Tentacle monster section aisle five, s
 {
  char buf[2048];
 
- while(fgets(buf,2048,fp) > 0)
+ while(fgets(buf,2048,fp) != NULL)
  {
   if(buf[0] == '[')
   {
@@ -2148,7 +2182,7 @@ void MDFN_LoadGameCheats(FILE *override)
 
  if(SeekToOurSection(fp))
  {
-  while(fgets(linebuf,2048,fp) > 0)
+  while(fgets(linebuf,2048,fp) != NULL)
   { 
    char namebuf[2048];
    char *tbuf=linebuf;
@@ -2290,7 +2324,7 @@ void MDFN_FlushGameCheats(int nosave)
   {
    FILE *tmp_fp = fopen(tmp_fn.c_str(), "wb");
 
-   while(fgets((char*)linebuf, 2048, fp) > 0)
+   while(fgets((char*)linebuf, 2048, fp) != NULL)
    {
     if(linebuf[0] == '[' && !insection)
     {
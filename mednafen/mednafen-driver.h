@@ -42,6 +42,7 @@ void MDFND_MidSync(const EmulateSpecStruct *espec);
 
 struct MDFN_Thread;
 struct MDFN_Mutex;
+struct MDFN_Cond;
 
 MDFN_Thread *MDFND_CreateThread(int (*fn)(void *), void *data);
 void MDFND_WaitThread(MDFN_Thread *thread, int *status);
@@ -52,6 +53,13 @@ void MDFND_DestroyMutex(MDFN_Mutex *mutex);
 int MDFND_LockMutex(MDFN_Mutex *mutex);
 int MDFND_UnlockMutex(MDFN_Mutex *mutex);
 
+// Condition variables.  MDFND_WaitCond() must be called with the mutex locked, and atomically unlocks it while waiting.
+// Signal with the same mutex locked, so a wakeup can't slip in between a waiter checking its condition and going to sleep.
+MDFN_Cond *MDFND_CreateCond(void);
+void MDFND_DestroyCond(MDFN_Cond *cond);
+int MDFND_WaitCond(MDFN_Cond *cond, MDFN_Mutex *mutex);
+int MDFND_SignalCond(MDFN_Cond *cond);
+
 /* End threading support. */
 
 void MDFNI_Reset(void);
@@ -85,6 +93,7 @@ void MDFN_DispMessage(const char *format, ...) throw() MDFN_FORMATSTR(printf, 1,
 #define MDFNI_DispMessage MDFN_DispMessage
 
 void MDFNI_SetLayerEnableMask(uint64 mask);
+void MDFNI_SetChanEnableMask(uint64 mask);
 
 void MDFNI_SetInput(int port, const char *type, void *ptr, uint32 dsize);
 
@@ -61,6 +61,8 @@ extern ArcadeCard *arcade_card;	// Bah, lousy globals.
 
 Blip_Buffer huc_sbuf;
 static Blip_Buffer sbuf[2];
+static uint64 ChanEnableMask;
+static bool SoundOutput;	// false while the frontend doesn't want any sound; nothing is synthesized then.
 static bool SetSoundRate(double rate);
 
 
@@ -299,6 +301,7 @@ static bool LoadCustomPalette(const char *path)
 
 static int LoadCommon(void);
 static void LoadCommonPre(void);
+static void ApplyChanEnableMask(void);
 
 static bool TestMagic(const char *name, MDFNFILE *fp)
 {
@@ -315,6 +318,7 @@ static void SetCDSettings(bool silent_status = false)
 
  cd_settings.CDDA_Volume = (double)MDFN_GetSettingUI("pce.cddavolume") / 100;
  cd_settings.CD_Speed = 1;
+ cd_settings.Fast_Read_Multiplier = MDFN_GetSettingUI("pce.fastcd");
 
  cd_settings.ADPCM_Volume = (double)MDFN_GetSettingUI("pce.adpcmvolume") / 100;
  cd_settings.ADPCM_LPF = MDFN_GetSettingB("pce.adpcmlp");
@@ -479,6 +483,9 @@ static int LoadCommon(void)
 
  psg->SetVolume(1.0);
 
+ ChanEnableMask = ~0ULL;
+ SoundOutput = true;
+
  if(PCE_IsCD)
   SetCDSettings();
 
@@ -499,6 +506,7 @@ static int LoadCommon(void)
  PCE_Power();
 
  MDFNGameInfo->LayerNames = IsSGX ? "BG0\0SPR0\0BG1\0SPR1\0" : "Background\0Sprites\0";
+ MDFNGameInfo->ChanNames = PCE_IsCD ? "PSG Ch0\0PSG Ch1\0PSG Ch2\0PSG Ch3\0PSG Ch4\0PSG Ch5\0ADPCM\0CD-DA\0" : "PSG Ch0\0PSG Ch1\0PSG Ch2\0PSG Ch3\0PSG Ch4\0PSG Ch5\0";
  MDFNGameInfo->fps = (uint32)((double)7159090.90909090 / 455 / 263 * 65536 * 256);
 
 
@@ -614,13 +622,6 @@ static bool TestMagicCD(std::vector<CDIF *> *CDInterfaces)
 
 static int LoadCD(std::vector<CDIF *> *CDInterfaces)
 {
- static const FileExtensionSpecStruct KnownBIOSExtensions[] =
- {
-  { ".pce", gettext_noop("PC Engine ROM Image") },
-  { ".bin", gettext_noop("PC Engine ROM Image") },
-  { ".bios", gettext_noop("BIOS Image") },
-  { NULL, NULL }
- };
  md5_context md5;
  uint32 headerlen = 0;
 
@@ -633,12 +634,12 @@ static int LoadCD(std::vector<CDIF *> *CDInterfaces)
  const char *bios_sname = DetectGECD((*CDInterfaces)[0]) ? "pce.gecdbios" : "pce.cdbios";
  std::string bios_path = MDFN_MakeFName(MDFNMKF_FIRMWARE, 0, MDFN_GetSettingS(bios_sname).c_str() );
 
- if(!fp.Open(bios_path, KnownBIOSExtensions, _("CD BIOS")))
+ if(!fp.Open(bios_path.c_str()))
  {
   return(0);
  }
 
- if(fp.Size() & 0x200)
+ if(fp.f_size & 0x200)
   headerlen = 512;
 
  bool disable_bram_cd = MDFN_GetSettingB("pce.disable_bram_cd");
@@ -646,7 +647,7 @@ static int LoadCD(std::vector<CDIF *> *CDInterfaces)
  if(disable_bram_cd)
   MDFN_printf(_("Warning: BRAM is disabled per pcfx.disable_bram_cd setting.  This is simulating a malfunction.\n"));
 
- if(!HuCLoad(fp.Data() + headerlen, fp.Size() - headerlen, 0, disable_bram_cd, PCE_ACEnabled ? SYSCARD_ARCADE : SYSCARD_3))
+ if(!HuCLoad(fp.f_data + headerlen, fp.f_size - headerlen, 0, disable_bram_cd, PCE_ACEnabled ? SYSCARD_ARCADE : SYSCARD_3))
  {
   return(0);
  }
@@ -719,7 +720,21 @@ static void Emulate(EmulateSpecStruct *espec)
  if(espec->SoundFormatChanged)
   SetSoundRate(espec->SoundRate);
 
- vce->StartFrame(espec->surface, &espec->DisplayRect, espec->LineWidths, espec->skip);
+ if(SoundOutput != (espec->SoundBuf != NULL))
+ {
+  SoundOutput = (espec->SoundBuf != NULL);
+  ApplyChanEnableMask();
+
+  // Whatever piled up in the buffers without end_frame() while sound was off is garbage.
+  if(SoundOutput)
+  {
+   for(int y = 0; y < 2; y++)
+    sbuf[y].clear();
+   huc_sbuf.clear();
+  }
+ }
+
+ vce->StartFrame(espec->surface, &espec->DisplayRect, espec->LineWidths, espec->LineDirty, espec->skip);
 
  // Begin loop here:
  bool rp_rv;
@@ -744,11 +759,9 @@ static void Emulate(EmulateSpecStruct *espec)
    huc_sbuf.end_frame(HuCPU->Timestamp() / 3);
 
    for(int y = 0; y < 2; y++)
-   {
     sbuf[y].end_frame(HuCPU->Timestamp() / 3);
 
-    new_sc = sbuf[y].read_samples(espec->SoundBuf + espec->SoundBufSize * 2 + y, espec->SoundBufMaxSize - espec->SoundBufSize, 1);
-   }
+   new_sc = sbuf[0].read_samples_stereo(sbuf[1], espec->SoundBuf + espec->SoundBufSize * 2, espec->SoundBufMaxSize - espec->SoundBufSize);
 
    if(huc_sbuf.clear_modified())
    {
@@ -773,6 +786,9 @@ static void Emulate(EmulateSpecStruct *espec)
    MDFN_MidSync(espec);
   }
  } while(!rp_rv);
+
+ if(espec->Palette && espec->surface->format.colorspace == MDFN_COLORSPACE_INDEXED)
+  vce->GetPalette(espec->Palette);
 }
 
 void PCE_MidSync(void)
@@ -942,6 +958,7 @@ static MDFNSetting PCESettings[] =
   { "pce.cdpsgvolume", MDFNSF_NOFLAGS, gettext_noop("PSG volume when playing a CD game."), NULL, MDFNST_UINT, "100", "0", "200", NULL, CDSettingChanged },
   { "pce.cddavolume", MDFNSF_NOFLAGS, gettext_noop("CD-DA volume."), NULL, MDFNST_UINT, "100", "0", "200", NULL, CDSettingChanged },
   { "pce.adpcmvolume", MDFNSF_NOFLAGS, gettext_noop("ADPCM volume."), NULL, MDFNST_UINT, "100", "0", "200", NULL, CDSettingChanged },
+  { "pce.fastcd", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("Fast CD data reads: transfer speed multiplier applied while no CD-DA or ADPCM is playing(0 = off)."), NULL, MDFNST_UINT, "0", "0", "100", NULL, CDSettingChanged },
 
   { "pce.vramsize", MDFNSF_NOFLAGS, gettext_noop("Size of emulated VRAM per VDC in 16-bit words.  DO NOT CHANGE THIS UNLESS YOU KNOW WTF YOU ARE DOING."), NULL, MDFNST_UINT, "32768", "32768", "65536" },
   { NULL }
@@ -988,6 +1005,22 @@ static void SetLayerEnableMask(uint64 mask)
  vce->SetLayerEnableMask(mask);
 }
 
+static void ApplyChanEnableMask(void)
+{
+ const uint64 mask = SoundOutput ? ChanEnableMask : 0;
+
+ psg->SetChanEnableMask(mask & 0x3F);
+
+ if(PCE_IsCD)
+  PCECD_SetChanEnableMask(mask >> 6);
+}
+
+static void SetChanEnableMask(uint64 mask)
+{
+ ChanEnableMask = mask;
+ ApplyChanEnableMask();
+}
+
 static const FileExtensionSpecStruct KnownExtensions[] =
 {
  { ".pce", gettext_noop("PC Engine ROM Image") },
@@ -1035,7 +1068,7 @@ MDFNGI EmulatedPCE =
  CloseGame,
  SetLayerEnableMask,
  NULL,
- NULL,
+ SetChanEnableMask,
  NULL,
  InstallReadPatch,
  RemoveReadPatches,
@@ -41,6 +41,8 @@ namespace MDFN_IEN_PCE
 
 static const int vce_ratios[4] = { 4, 3, 2, 2 };
 
+static uint64 LineHash[263];
+
 static void IRQChange_Hook(bool newstatus)
 {
  extern VCE *vce; //HORRIBLE
@@ -120,6 +122,7 @@ VCE::VCE(bool want_sgfx, bool nospritelimit)
 
  fb = NULL;
  pitch32 = 0;
+ memset(LineHash, 0, sizeof(LineHash));
  RunHook = NULL;
  HBlankHook = NULL;
  VBlankHook = NULL;
@@ -137,6 +140,8 @@ VCE::VCE(bool want_sgfx, bool nospritelimit)
 
  memset(systemColorMap32, 0, sizeof(systemColorMap32));
  memset(bw_systemColorMap32, 0, sizeof(bw_systemColorMap32));
+ memset(systemPalette, 0, sizeof(systemPalette));
+ IndexedOutput = false;
 
  #ifdef WANT_DEBUGGER
  GfxDecode_Buf = NULL;
@@ -207,8 +212,11 @@ void VCE::Reset(const int32 timestamp)
 }
 
 static MDFN_Rect *LW;
+static uint32 *LD;
 
 static bool skipframe;
+static bool skipline;	// skipframe, or the current line is outside of DisplayRect
+static int32 display_start, display_end;
 
 /*
  Note:  If we're skipping the frame, don't write to the data behind the pXBuf, DisplayRect, and LineWidths
@@ -216,7 +224,7 @@ static bool skipframe;
  there will be graphics distortion, and maybe memory corruption.
 */
 
-void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, int skip)
+void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, uint32 *LineDirty, int skip)
 {
  uint16 *pXBuf = surface->pixels16;
 
@@ -224,7 +232,10 @@ void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *L
 
  //printf("Clock divider: %d\n", clock_divider);
 
- color_table_cache[0x200] = color_table_cache[0x300] = surface->format.MakeColor(0x00, 0xFE, 0x00);
+ if(IndexedOutput)
+  color_table_cache[0x200] = color_table_cache[0x300] = 0x1C0;	// Brightest green
+ else
+  color_table_cache[0x200] = color_table_cache[0x300] = surface->format.MakeColor(0x00, 0xFE, 0x00);
 
  if(!skip)
  {
@@ -236,12 +247,19 @@ void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *L
   DisplayRect->y = 14 + MDFN_GetSettingUI("pce.slstart");
   DisplayRect->h = MDFN_GetSettingUI("pce.slend") - MDFN_GetSettingUI("pce.slstart") + 1;
 
+  display_start = DisplayRect->y;
+  display_end = DisplayRect->y + DisplayRect->h;
+
   for(int y = 0; y < 263; y++)
    LineWidths[y].w = 0;
 
+  if(LineDirty)
+   memset(LineDirty, 0, (263 + 31) / 32 * sizeof(uint32));
+
   pitch32 = surface->pitch32;
   fb = pXBuf;
   LW = LineWidths;
+  LD = LineDirty;
   scanline_out_ptr = &fb[scanline * pitch32];
  }
  else
@@ -249,10 +267,12 @@ void VCE::StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *L
   pitch32 = 0;
   fb = NULL;
   LW = NULL;
+  LD = NULL;
   scanline_out_ptr = NULL;
  }
 
  skipframe = skip;
+ skipline = skipframe || scanline < display_start || scanline >= display_end;
 }
 
 bool VCE::RunPartial(void)
@@ -302,6 +322,52 @@ bool VCE::RunPartial(void)
  return(FrameDone);
 }
 
+// Composites a span of SuperGrafx pixels, all under the same VPC priority setting.  Each case is a straight loop of
+// selects, so the compiler can keep it branch-free.
+static INLINE void MixSGFXSpan(uint16 *target, const uint16 *vdc1, const uint16 *vdc2, const int32 count, const uint8 pb, const uint32 *ctc)
+{
+ const uint32 vdc1_mask = (pb & 1) ? 0xFFFF : 0;
+ const uint32 vdc2_mask = (pb & 2) ? 0xFFFF : 0;
+
+ /* Dai MakaiMura uses setting 1, and expects VDC #2 sprites in front of VDC #1 background, but
+    behind VDC #1's sprites.
+ */
+ switch(pb >> 2)
+ {
+  default:
+	for(int32 i = 0; i < count; i++)
+	{
+	 const uint32 vdc1_pixel = vdc1[i] & vdc1_mask;
+	 const uint32 vdc2_pixel = vdc2[i] & vdc2_mask;
+
+	 target[i] = ctc[((vdc1_pixel & 0xF) ? vdc1_pixel : vdc2_pixel) & 0x1FF];
+	}
+	break;
+
+  case 1:
+	for(int32 i = 0; i < count; i++)
+	{
+	 const uint32 vdc2_pixel = vdc2[i] & vdc2_mask;
+	 uint32 vdc1_pixel = vdc1[i] & vdc1_mask;
+
+	 vdc1_pixel = ((vdc2_pixel & ~vdc1_pixel & 0x100) && (vdc2_pixel & 0xF)) ? 0 : vdc1_pixel;
+	 target[i] = ctc[((vdc1_pixel & 0xF) ? vdc1_pixel : vdc2_pixel) & 0x1FF];
+	}
+	break;
+
+  case 2:
+	for(int32 i = 0; i < count; i++)
+	{
+	 const uint32 vdc2_pixel = vdc2[i] & vdc2_mask;
+	 uint32 vdc1_pixel = vdc1[i] & vdc1_mask;
+
+	 vdc1_pixel = ((vdc1_pixel & ~vdc2_pixel & 0x100) && (vdc2_pixel & 0xF)) ? 0 : vdc1_pixel;
+	 target[i] = ctc[((vdc1_pixel & 0xF) ? vdc1_pixel : vdc2_pixel) & 0x1FF];
+	}
+	break;
+ }
+}
+
 // If we ignore the return value of Sync(), we must do "HuCPU->SetEvent(CalcNextEvent());"
 // before the function(read/write functions) that called Sync() return!
 int32 VCE::Sync(const int32 timestamp)
@@ -368,6 +434,8 @@ void VCE::SetVCECR(uint8 V)
 
 void VCE::SetPixelFormat(const MDFN_PixelFormat &format)
 {
+ IndexedOutput = (format.colorspace == MDFN_COLORSPACE_INDEXED);
+
  for(int x = 0; x < 512; x++)
  {
   int r, g, b;
@@ -407,8 +475,24 @@ void VCE::SetPixelFormat(const MDFN_PixelFormat &format)
    sc_r = sc_g = sc_b = y;
   }
 
-  systemColorMap32[x] = format.MakeColor(r, g, b);
-  bw_systemColorMap32[x] = format.MakeColor(sc_r, sc_g, sc_b);
+  systemPalette[x].r = r;
+  systemPalette[x].g = g;
+  systemPalette[x].b = b;
+
+  systemPalette[512 + x].r = sc_r;
+  systemPalette[512 + x].g = sc_g;
+  systemPalette[512 + x].b = sc_b;
+
+  if(IndexedOutput)
+  {
+   systemColorMap32[x] = x;
+   bw_systemColorMap32[x] = 512 + x;
+  }
+  else
+  {
+   systemColorMap32[x] = format.MakeColor(r, g, b);
+   bw_systemColorMap32[x] = format.MakeColor(sc_r, sc_g, sc_b);
+  }
  }
 
  // I know the temptation is there, but don't combine these two loops just
@@ -430,6 +514,11 @@ void VCE::SetPixelFormat(const MDFN_PixelFormat &format)
  }
 }
 
+void VCE::GetPalette(MDFN_PaletteEntry *palette)
+{
+ memcpy(palette, systemPalette, sizeof(systemPalette));
+}
+
 bool VCE::SetCustomColorMap(const uint8 *triplets, const uint32 count)
 {
  assert(count == 512 || count == 1024);
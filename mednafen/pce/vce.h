@@ -40,8 +40,9 @@ class VCE : public HuC6280_Support
 
 	void SetPixelFormat(const MDFN_PixelFormat &format);
 	bool SetCustomColorMap(const uint8 *triplets, const uint32 count);	// count = 512 or 1024
+	void GetPalette(MDFN_PaletteEntry *palette);
 
-	void StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, int skip);
+	void StartFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, uint32 *LineDirty, int skip);
 	bool RunPartial(void);
 
 	inline int GetScanlineNo(void)
@@ -208,6 +209,15 @@ class VCE : public HuC6280_Support
 	void DoGfxDecode(void);
 	#endif
 
+	// VPC priority/enable setting for the given combination of windows(bit 0 = window 1, bit 1 = window 2).
+	INLINE uint8 GetSGFXPriority(int in_window)
+	{
+	 static const int prio_select[4] = { 1, 1, 0, 0 };
+	 static const int prio_shift[4] = { 4, 0, 4, 0 };
+
+	 return((priority[prio_select[in_window]] >> prio_shift[in_window]) & 0xF);
+	}
+
 	INLINE int32 CalcNextEvent(void)
 	{
 	 int32 next_event = hblank_counter;
@@ -281,6 +291,8 @@ class VCE : public HuC6280_Support
 	uint32 CustomColorMapLen;        // 512 or 1024
 
 	uint32 systemColorMap32[512], bw_systemColorMap32[512];
+	MDFN_PaletteEntry systemPalette[1024];	// Second half is the black and white colors.
+	bool IndexedOutput;	// Surface takes palette indices rather than colors.
 
 	int32 last_ts;
 
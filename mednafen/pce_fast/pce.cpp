@@ -37,6 +37,8 @@ static PCE_PSG *psg = NULL;
 extern ArcadeCard *arcade_card; // Bah, lousy globals.
 
 static Blip_Buffer sbuf[2];
+static uint64 ChanEnableMask;
+static bool SoundOutput;	// false while the frontend doesn't want any sound; nothing is synthesized then.
 
 bool PCE_ACEnabled;
 
@@ -169,6 +171,7 @@ bool PCE_InitCD(void)
 
  cd_settings.CDDA_Volume = (double)MDFN_GetSettingUI("pce_fast.cddavolume") / 100;
  cd_settings.CD_Speed = MDFN_GetSettingUI("pce_fast.cdspeed");
+ cd_settings.Fast_Read_Multiplier = MDFN_GetSettingUI("pce_fast.fastcd");
 
  cd_settings.ADPCM_Volume = (double)MDFN_GetSettingUI("pce_fast.adpcmvolume") / 100;
  cd_settings.ADPCM_LPF = MDFN_GetSettingB("pce_fast.adpcmlp");
@@ -185,6 +188,7 @@ bool PCE_InitCD(void)
 
 static int LoadCommon(void);
 static void LoadCommonPre(void);
+static void ApplyChanEnableMask(void);
 
 static bool TestMagic(const char *name, MDFNFILE *fp)
 {
@@ -272,6 +276,9 @@ static void LoadCommonPre(void)
  if(MDFN_GetSettingUI("pce_fast.cdspeed") > 1)
   MDFN_printf(_("CD-ROM speed:  %ux\n"), (unsigned int)MDFN_GetSettingUI("pce_fast.cdspeed"));
 
+ if(MDFN_GetSettingUI("pce_fast.fastcd") > 1)
+  MDFN_printf(_("Fast CD reads: %ux\n"), (unsigned int)MDFN_GetSettingUI("pce_fast.fastcd"));
+
  memset(HuCPUFastMap, 0, sizeof(HuCPUFastMap));
  for(int x = 0; x < 0x100; x++)
  {
@@ -325,6 +332,9 @@ static int LoadCommon(void)
 
  psg->SetVolume(1.0);
 
+ ChanEnableMask = ~0ULL;
+ SoundOutput = true;
+
  if(PCE_IsCD)
  {
   unsigned int cdpsgvolume = MDFN_GetSettingUI("pce_fast.cdpsgvolume");
@@ -343,6 +353,7 @@ static int LoadCommon(void)
  PCE_Power();
 
  MDFNGameInfo->LayerNames = IsSGX ? "BG0\0SPR0\0BG1\0SPR1\0" : "Background\0Sprites\0";
+ MDFNGameInfo->ChanNames = PCE_IsCD ? "PSG Ch0\0PSG Ch1\0PSG Ch2\0PSG Ch3\0PSG Ch4\0PSG Ch5\0ADPCM\0CD-DA\0" : "PSG Ch0\0PSG Ch1\0PSG Ch2\0PSG Ch3\0PSG Ch4\0PSG Ch5\0";
  MDFNGameInfo->fps = (uint32)((double)7159090.90909090 / 455 / 263 * 65536 * 256);
 
  // Clean this up:
@@ -467,7 +478,24 @@ static void Emulate(EmulateSpecStruct *espec)
    sbuf[y].bass_freq(20);
   }
  }
- VDC_RunFrame(espec->surface, &espec->DisplayRect, espec->LineWidths, /* IsHES ? 1 : */espec->skip);
+
+ if(SoundOutput != (espec->SoundBuf != NULL))
+ {
+  SoundOutput = (espec->SoundBuf != NULL);
+  ApplyChanEnableMask();
+
+  // Whatever piled up in the buffers without end_frame() while sound was off is garbage.
+  if(SoundOutput)
+  {
+   for(int y = 0; y < 2; y++)
+    sbuf[y].clear();
+  }
+ }
+
+ VDC_RunFrame(espec->surface, &espec->DisplayRect, espec->LineWidths, espec->LineDirty, /* IsHES ? 1 : */espec->skip);
+
+ if(espec->Palette && espec->surface->format.colorspace == MDFN_COLORSPACE_INDEXED)
+  VDC_GetPalette(espec->Palette);
 
 
  if(PCE_IsCD)
@@ -482,10 +510,9 @@ static void Emulate(EmulateSpecStruct *espec)
  if(espec->SoundBuf)
  {
   for(int y = 0; y < 2; y++)
-  {
    sbuf[y].end_frame(HuCPU.timestamp / pce_overclocked);
-   espec->SoundBufSize = sbuf[y].read_samples(espec->SoundBuf + y, espec->SoundBufMaxSize, 1);
-  }
+
+  espec->SoundBufSize = sbuf[0].read_samples_stereo(sbuf[1], espec->SoundBuf, espec->SoundBufMaxSize);
  }
 
  espec->MasterCycles = HuCPU.timestamp * 3;
@@ -550,6 +577,22 @@ void PCE_Power(void)
  }
 }
 
+static void ApplyChanEnableMask(void)
+{
+ const uint64 mask = SoundOutput ? ChanEnableMask : 0;
+
+ psg->SetChanEnableMask(mask & 0x3F);
+
+ if(PCE_IsCD)
+  PCECD_SetChanEnableMask(mask >> 6);
+}
+
+static void SetChanEnableMask(uint64 mask)
+{
+ ChanEnableMask = mask;
+ ApplyChanEnableMask();
+}
+
 static void DoSimpleCommand(int cmd)
 {
  switch(cmd)
@@ -579,6 +622,7 @@ static MDFNSetting PCESettings[] =
   { "pce_fast.arcadecard", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("Enable Arcade Card emulation."), NULL, MDFNST_BOOL, "1" },
   { "pce_fast.ocmultiplier", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("CPU overclock multiplier."), NULL, MDFNST_UINT, "1", "1", "100"},
   { "pce_fast.cdspeed", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("CD-ROM data transfer speed multiplier."), NULL, MDFNST_UINT, "1", "1", "100" },
+  { "pce_fast.fastcd", MDFNSF_EMU_STATE | MDFNSF_UNTRUSTED_SAFE, gettext_noop("Fast CD data reads: transfer speed multiplier applied while no CD-DA or ADPCM is playing(0 = off)."), NULL, MDFNST_UINT, "0", "0", "100" },
   { "pce_fast.nospritelimit", MDFNSF_NOFLAGS, gettext_noop("Remove 16-sprites-per-scanline hardware limit."), NULL, MDFNST_BOOL, "0" },
 
   { "pce_fast.cdbios", MDFNSF_EMU_STATE, gettext_noop("Path to the CD BIOS"), NULL, MDFNST_STRING, "syscard3.pce" },
@@ -617,7 +661,7 @@ MDFNGI EmulatedPCE_Fast =
  CloseGame,
  VDC_SetLayerEnableMask,
  NULL,
- NULL,
+ SetChanEnableMask,
  NULL,
  NULL,
  NULL,
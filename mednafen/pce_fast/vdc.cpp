@@ -40,6 +40,7 @@ The spectrum peaked at 15734 Hz.  21477272.727272... / 3 / 15734 = 455.00(CPU cy
 static uint8 *CustomColorMap = NULL; // 1024 * 3
 static uint32 CustomColorMapLen;      // 512 or 1024
 static uint32 systemColorMap32[512], bw_systemColorMap32[512];
+static MDFN_PaletteEntry systemPalette[1024];	// Second half is the black and white colors.
 static uint32 amask;    // Alpha channel maskaroo
 static uint32 amask_shift;
 static uint32 userle; // User layer enable.
@@ -48,6 +49,8 @@ static uint32 disabled_layer_color;
 static bool unlimited_sprites;
 static bool correct_aspect;
 
+static uint64 line_hash[242];	// For LineDirty
+
 #define ULE_BG0		1
 #define ULE_SPR0	2
 #define ULE_BG1		4
@@ -222,8 +225,10 @@ vpc_t vpc;
 
 void VDC_SetPixelFormat(const MDFN_PixelFormat &format)
 {
- amask = 1 << format.Ashift;
- amask_shift = format.Ashift;
+ // The flag bits ride above the color in color_table_cache and are cut off when pixels are stored.  Palette indices take up
+ // the low 10 bits, so in indexed mode they get fixed high bits rather than the surface's(meaningless) alpha position.
+ amask_shift = (format.colorspace == MDFN_COLORSPACE_INDEXED) ? 24 : format.Ashift;
+ amask = 1 << amask_shift;
 
  for(int x = 0; x < 512; x++)
  {
@@ -264,8 +269,24 @@ void VDC_SetPixelFormat(const MDFN_PixelFormat &format)
    sc_r = sc_g = sc_b = y;
   }
 
-  systemColorMap32[x] = format.MakeColor(r, g, b);
-  bw_systemColorMap32[x] = format.MakeColor(sc_r, sc_g, sc_b);
+  systemPalette[x].r = r;
+  systemPalette[x].g = g;
+  systemPalette[x].b = b;
+
+  systemPalette[512 + x].r = sc_r;
+  systemPalette[512 + x].g = sc_g;
+  systemPalette[512 + x].b = sc_b;
+
+  if(format.colorspace == MDFN_COLORSPACE_INDEXED)
+  {
+   systemColorMap32[x] = x;
+   bw_systemColorMap32[x] = 512 + x;
+  }
+  else
+  {
+   systemColorMap32[x] = format.MakeColor(r, g, b);
+   bw_systemColorMap32[x] = format.MakeColor(sc_r, sc_g, sc_b);
+  }
  }
 
  // I know the temptation is there, but don't combine these two loops just
@@ -273,7 +294,15 @@ void VDC_SetPixelFormat(const MDFN_PixelFormat &format)
  for(int x = 0; x < 512; x++)
   FixPCache(x);
 
- disabled_layer_color = format.MakeColor(0x00, 0xFE, 0x00);
+ if(format.colorspace == MDFN_COLORSPACE_INDEXED)
+  disabled_layer_color = 0x1C0;	// Brightest green
+ else
+  disabled_layer_color = format.MakeColor(0x00, 0xFE, 0x00);
+}
+
+void VDC_GetPalette(MDFN_PaletteEntry *palette)
+{
+ memcpy(palette, systemPalette, sizeof(systemPalette));
 }
 
 DECLFR(VCE_Read)
@@ -1078,7 +1107,7 @@ void DrawOverscan(const vdc_t *vdc, T *target, const MDFN_Rect *lw, const bool f
  }
 }
 
-void VDC_RunFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, int skip)
+void VDC_RunFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, uint32 *LineDirty, int skip)
 {
  vdc_t *vdc = vdc_chips[0];
  int max_dc = 0;
@@ -1428,6 +1457,27 @@ void VDC_RunFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *Line
      DrawOverscan(vdc_chips[0], target_ptr, DisplayRect);
    }
   }
+
+  if(LineDirty)
+  {
+   memset(LineDirty, 0, (242 + 31) / 32 * sizeof(uint32));
+
+   for(int y = DisplayRect->y; y < DisplayRect->y + DisplayRect->h; y++)
+   {
+    uint64 hash;
+
+    if(surface->format.bpp == 16)
+     hash = MDFN_HashLine(surface->pixels16 + y * surface->pitchinpix + LineWidths[y].x, LineWidths[y].w);
+    else
+     hash = MDFN_HashLine((uint16 *)(surface->pixels + y * surface->pitchinpix + LineWidths[y].x), LineWidths[y].w * 2);
+
+    if(hash != line_hash[y])
+    {
+     LineDirty[y >> 5] |= 1U << (y & 31);
+     line_hash[y] = hash;
+    }
+   }
+  }
  }
 }
 
@@ -1502,6 +1552,8 @@ void VDC_Init(int sgx)
 
  VDC_TotalChips = sgx ? 2 : 1;
 
+ memset(line_hash, 0, sizeof(line_hash));
+
  for(int chip = 0; chip < VDC_TotalChips; chip++)
  {
   vdc_chips[chip] = (vdc_t *)MDFN_malloc(sizeof(vdc_t), "VDC");
@@ -109,7 +109,8 @@ extern int VDC_TotalChips;
 
 
 void VDC_SetPixelFormat(const MDFN_PixelFormat &format);
-void VDC_RunFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, int skip);
+void VDC_GetPalette(MDFN_PaletteEntry *palette);
+void VDC_RunFrame(MDFN_Surface *surface, MDFN_Rect *DisplayRect, MDFN_Rect *LineWidths, uint32 *LineDirty, int skip);
 void VDC_SetLayerEnableMask(uint64 mask);
 
 DECLFW(VDC_Write);
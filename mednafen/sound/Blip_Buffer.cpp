@@ -8,6 +8,10 @@
 #include <stdlib.h>
 #include <math.h>
 
+#if defined(ARCH_X86) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef GEKKO
 #define ULLONG_MAX ULONG_MAX
 #endif
@@ -435,6 +439,85 @@ long Blip_Buffer::read_samples( blip_sample_t* BLIP_RESTRICT out, long max_sampl
 	return count;
 }
 
+long Blip_Buffer::read_samples_stereo( Blip_Buffer& right, blip_sample_t* BLIP_RESTRICT out, long max_samples )
+{
+	long count = samples_avail();
+	if ( count > right.samples_avail() )
+		count = right.samples_avail();
+	if ( count > max_samples )
+		count = max_samples;
+	
+	if ( count )
+	{
+		int const bass = BLIP_READER_BASS( *this );
+		buf_t_ const* BLIP_RESTRICT in_l = buffer_;
+		buf_t_ const* BLIP_RESTRICT in_r = right.buffer_;
+		blip_long accum_l = reader_accum_;
+		blip_long accum_r = right.reader_accum_;
+		long n = count;
+		
+	#if defined(ARCH_X86) && defined(__SSE2__)
+		// Left and right accumulators in lanes 0 and 1; the integration itself is
+		// serial, but four samples at a time are loaded, saturated and packed together.
+		__m128i accum = _mm_unpacklo_epi32( _mm_cvtsi32_si128( accum_l ), _mm_cvtsi32_si128( accum_r ) );
+		__m128i const bass_shift = _mm_cvtsi32_si128( bass );
+		
+		#define BLIP_STEREO_NEXT( s, in ) \
+			s = _mm_srai_epi32( accum, blip_sample_bits - 16 ); \
+			accum = _mm_add_epi32( accum, _mm_sub_epi32( in, _mm_sra_epi32( accum, bass_shift ) ) )
+		
+		for ( ; n >= 4; n -= 4 )
+		{
+			__m128i l = _mm_loadu_si128( (__m128i const*) in_l );
+			__m128i r = _mm_loadu_si128( (__m128i const*) in_r );
+			__m128i lr01 = _mm_unpacklo_epi32( l, r );
+			__m128i lr23 = _mm_unpackhi_epi32( l, r );
+			__m128i s0, s1, s2, s3;
+			
+			BLIP_STEREO_NEXT( s0, lr01 );
+			BLIP_STEREO_NEXT( s1, _mm_srli_si128( lr01, 8 ) );
+			BLIP_STEREO_NEXT( s2, lr23 );
+			BLIP_STEREO_NEXT( s3, _mm_srli_si128( lr23, 8 ) );
+			
+			_mm_storeu_si128( (__m128i*) out, _mm_packs_epi32( _mm_unpacklo_epi64( s0, s1 ), _mm_unpacklo_epi64( s2, s3 ) ) );
+			
+			in_l += 4;
+			in_r += 4;
+			out += 8;
+		}
+		
+		#undef BLIP_STEREO_NEXT
+		
+		accum_l = _mm_cvtsi128_si32( accum );
+		accum_r = _mm_cvtsi128_si32( _mm_srli_si128( accum, 4 ) );
+	#endif
+		
+		for ( ; n; --n )
+		{
+			blip_long s = accum_l >> (blip_sample_bits - 16);
+			if ( (blip_sample_t) s != s )
+				s = 0x7FFF - (s >> 24);
+			out [0] = (blip_sample_t) s;
+			
+			s = accum_r >> (blip_sample_bits - 16);
+			if ( (blip_sample_t) s != s )
+				s = 0x7FFF - (s >> 24);
+			out [1] = (blip_sample_t) s;
+			out += 2;
+			
+			accum_l += *in_l++ - (accum_l >> bass);
+			accum_r += *in_r++ - (accum_r >> bass);
+		}
+		
+		reader_accum_ = accum_l;
+		right.reader_accum_ = accum_r;
+		
+		remove_samples( count );
+		right.remove_samples( count );
+	}
+	return count;
+}
+
 void Blip_Buffer::mix_samples( blip_sample_t const* in, long count )
 {
 	if ( buffer_size_ == silent_buf_size )
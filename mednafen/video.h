@@ -3,6 +3,27 @@
 
 #include "video/surface.h"
 
+// Hash of the visible part of a rendered line, used by the emulation code to fill in EmulateSpecStruct::LineDirty.
+// Four independent lanes so the multiplies don't serialize.
+static INLINE uint64 MDFN_HashLine(const uint16 *pixels, const int32 count)
+{
+ uint32 h0 = 0x811C9DC5 ^ count, h1 = 0x811C9DC5, h2 = 0x811C9DC5, h3 = 0x811C9DC5;
+ int32 i = 0;
+
+ for(; i + 4 <= count; i += 4)
+ {
+  h0 = (h0 ^ pixels[i + 0]) * 0x01000193;
+  h1 = (h1 ^ pixels[i + 1]) * 0x01000193;
+  h2 = (h2 ^ pixels[i + 2]) * 0x01000193;
+  h3 = (h3 ^ pixels[i + 3]) * 0x01000193;
+ }
+
+ for(; i < count; i++)
+  h0 = (h0 ^ pixels[i]) * 0x01000193;
+
+ return(((uint64)(h0 ^ (h2 * 0x01000193)) << 32) | (h1 ^ (h3 * 0x01000193)));
+}
+
 void MDFN_ResetMessages(void);
 void MDFN_DispMessage(const char *format, ...) throw() MDFN_FORMATSTR(printf, 1, 2);
 
@@ -11,6 +11,8 @@ enum
  MDFN_COLORSPACE_RGB = 0,
  MDFN_COLORSPACE_YCbCr = 1,
  //MDFN_COLORSPACE_YUV = 2, // TODO, maybe.
+ // 16bpp; pixels are palette indices, see EmulateSpecStruct::Palette.  The component shifts, Ashift included, are ignored.
+ MDFN_COLORSPACE_INDEXED = 3,
 };
 
 class MDFN_PixelFormat